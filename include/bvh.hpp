@@ -0,0 +1,182 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "vector3.hpp"
+#include "ray.hpp"
+
+class object;
+class camera;
+
+const double DEFAULT_BVH_MARGIN = 0.1; ///< Default distance by which object bounding boxes are enlarged in the tree (in m)
+
+const size_t MAX_BVH_CHANGES = 1024; ///< Number of changed regions kept by a tree before they are merged into one (see bvh::getChanges())
+
+/** @class bvh
+  * @brief Dynamic bounding volume hierarchy of axis-aligned boxes over a set of objects
+  *
+  * Each leaf holds one object and a copy of its bounding box, enlarged by a small margin. When an object
+  * moves or rotates it calls update(), which does nothing as long as the object still fits inside its
+  * enlarged box. Otherwise, the leaf is removed and re-inserted next to the sibling which increases the
+  * total surface area of the tree the least, and the boxes of all of its ancestors are refit. Calling
+  * rebuild() rebuilds the entire tree from scratch, which may be useful after many objects have moved.
+  */
+
+class bvh{
+public:
+	/** @class region
+	  * @brief Axis-aligned box in which objects were added, removed, or moved
+	  */
+	class region{
+	public:
+		vector3 boxMin; ///< Minimum corner of the box
+		vector3 boxMax; ///< Maximum corner of the box
+
+		/** Box constructor
+		  */
+		region(const vector3 &boxMin_, const vector3 &boxMax_) : boxMin(boxMin_), boxMax(boxMax_) { }
+	};
+
+	/** Default constructor
+	  */
+	bvh();
+
+	/** Destructor
+	  * @note Objects are not deleted, they are only detached from the tree
+	  */
+	~bvh();
+
+	/** Get the number of objects in the tree
+	  */
+	size_t getNumberOfObjects() const { return nObjects; }
+
+	/** Get the distance by which object bounding boxes are enlarged in the tree
+	  */
+	double getMargin() const { return margin; }
+
+	/** Get the regions in which objects have been added, removed, or moved since the last call to clearChanges()
+	  * @note Useful for deciding which data that depends on the placement of objects (e.g. shadows) is out of date.
+	  *       Each region encloses the old and the new enlarged box of an object. Once there are more than
+	  *       MAX_BVH_CHANGES of them, they are merged into a single region
+	  */
+	const std::vector<region>& getChanges() const { return changes; }
+
+	/** Forget all of the regions returned by getChanges()
+	  */
+	void clearChanges(){ changes.clear(); }
+
+	/** Get the box which bounds every object in the tree, including the margin
+	  * @return False if the tree is empty and return true otherwise
+	  */
+	bool getBounds(vector3 &boxMin, vector3 &boxMax) const ;
+
+	/** Set the distance by which object bounding boxes are enlarged in the tree
+	  * @note Only affects objects which are inserted or re-inserted after the call
+	  */
+	void setMargin(const double &margin_){ margin = margin_; }
+
+	/** Add an object to the tree
+	  * @note An object may only belong to one tree at a time
+	  */
+	void insert(object *obj);
+
+	/** Remove an object from the tree
+	  */
+	void remove(object *obj);
+
+	/** Update the tree after the bounding box of an object has changed
+	  */
+	void update(object *obj);
+
+	/** Rebuild the entire tree from scratch, splitting the objects along the longest axis at each level
+	  */
+	void rebuild();
+
+	/** Remove all objects from the tree
+	  */
+	void clear();
+
+	/** Find all objects which are at least partially inside the viewing frustum of a camera
+	  * @param cam The camera whose frustum will be tested
+	  * @param output Vector which all visible objects will be appended to
+	  */
+	void queryFrustum(const camera *cam, std::vector<object*> &output) const ;
+
+	/** Find all objects whose bounding boxes overlap an axis-aligned box
+	  * @param boxMin The minimum corner of the box (in real-space)
+	  * @param boxMax The maximum corner of the box (in real-space)
+	  * @param output Vector which all overlapping objects will be appended to
+	  */
+	void queryBox(const vector3 &boxMin, const vector3 &boxMax, std::vector<object*> &output) const ;
+
+	/** Find the closest object whose polygons are intersected by a ray
+	  * @param r The ray to cast
+	  * @param t The distance along the ray to the closest intersection
+	  * @return Pointer to the closest intersected object, or NULL if no object is intersected
+	  */
+	object* raycast(const ray &r, double &t) const ;
+
+private:
+	/** @class node
+	  * @brief A single leaf or internal node of the tree
+	  */
+	class node{
+	public:
+		vector3 boxMin; ///< Minimum corner of the bounding box of the node
+		vector3 boxMax; ///< Maximum corner of the bounding box of the node
+
+		int parent; ///< Index of the parent node (or of the next free node when the node is unused)
+		int left; ///< Index of the left child node (-1 for leaves)
+		int right; ///< Index of the right child node (-1 for leaves)
+
+		object *obj; ///< The object held by a leaf node (NULL for internal nodes)
+
+		/** Return true if this is a leaf node and return false otherwise
+		  */
+		bool isLeaf() const { return (left < 0); }
+	};
+
+	std::vector<node> nodes; ///< Storage for all nodes, including unused ones
+
+	int root; ///< Index of the root node (-1 for an empty tree)
+	int freeList; ///< Index of the first unused node (-1 if there are none)
+
+	size_t nObjects; ///< Number of objects in the tree
+
+	double margin; ///< Distance by which object bounding boxes are enlarged
+
+	std::vector<region> changes; ///< Regions in which objects have been added, removed, or moved since the last call to clearChanges()
+
+	/** Get an unused node, growing the node storage if needed
+	  */
+	int allocateNode();
+
+	/** Add a region to the list of changes, merging all of them into one if there are too many
+	  */
+	void addChange(const vector3 &boxMin, const vector3 &boxMax);
+
+	/** Return a node to the list of unused nodes
+	  */
+	void freeNode(const int &index);
+
+	/** Insert a leaf node into the tree next to the sibling which adds the least surface area
+	  */
+	void insertLeaf(const int &leaf);
+
+	/** Remove a leaf node from the tree, along with its parent
+	  */
+	void removeLeaf(const int &leaf);
+
+	/** Recompute the bounding boxes of a node and all of its ancestors from their children
+	  */
+	void refit(int index);
+
+	/** Recursively build a subtree from a range of leaf nodes
+	  * @return The index of the root of the subtree
+	  */
+	int build(int *leaves, const size_t &count);
+};
+
+#endif
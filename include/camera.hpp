@@ -4,6 +4,8 @@
 #include <vector>
 
 #include "ray.hpp"
+#include "matrix4.hpp"
+#include "quaternion.hpp"
 #include "plane.hpp"
 #include "triangle.hpp"
 #include "colors.hpp"
@@ -15,6 +17,10 @@ extern const double rad2deg;
 
 class object;
 
+/** Planes which bound the camera's viewing frustum
+  */
+enum frustumPlane {FRUSTUM_LEFT, FRUSTUM_RIGHT, FRUSTUM_BOTTOM, FRUSTUM_TOP, FRUSTUM_NEAR, FRUSTUM_FAR};
+
 /** @class camera
   * @brief Handles all projections of 3d geometry onto the screen
   * @author Cory R. Thornsberry
@@ -51,6 +57,49 @@ public:
 	  */
 	void setAspectRatio(const double &ratio);
 
+	/** Set the maximum distance from the camera, along its viewing axis, at which objects are drawn (in m)
+	  */
+	void setViewDistance(const double &dist);
+
+	/** Get the maximum distance from the camera, along its viewing axis, at which objects are drawn (in m)
+	  */
+	double getViewDistance() const { return viewDistance; }
+
+	/** Get the position of the camera's focal point
+	  */
+	vector3 getPosition() const { return pos; }
+
+	/** Get the distance from the focal point to the viewing plane (in m)
+	  */
+	double getFocalLength() const { return L; }
+
+	/** Get the height of the viewing plane (in m)
+	  */
+	double getViewingPlaneHeight() const { return H; }
+
+	/** Get one of the six planes which bound the viewing frustum
+	  * @note The normal vector of each plane has unit length and points toward the inside of the frustum
+	  */
+	const plane& getFrustumPlane(const frustumPlane &which) const { return frustum[which]; }
+
+	/** Get the matrix which transforms real-space points into the camera's reference frame
+	  */
+	const matrix4& getViewMatrix() const { return view; }
+
+	/** Get the matrix which transforms points in the camera's reference frame into homogeneous clip-space
+	  * @note After dividing by the homogeneous (w) component, x and y are in screen-space [-1, 1] and z is
+	  *       the normalized reciprocal depth L/w. Points with w <= L lie behind the viewing plane
+	  */
+	const matrix4& getProjectionMatrix() const { return proj; }
+
+	/** Get the combined view-projection matrix which transforms real-space points directly into clip-space
+	  */
+	const matrix4& getViewProjectionMatrix() const { return viewProj; }
+
+	/** Get the orientation of the camera
+	  */
+	const quaternion& getOrientation() const { return orient; }
+
 /////////////////////////////////////////////////
 // Movement methods
 /////////////////////////////////////////////////
@@ -104,10 +153,18 @@ public:
 	  */
 	void rotate(const double &theta, const double &phi, const double &psi);
 
+	/** Rotate the camera from its current orientation by a rotation quaternion
+	  */
+	void rotate(const quaternion &rotation);
+
 	/** Rotate the object to specified angles using the pitch-roll-yaw convention (all in radians)
 	  */
 	void setRotation(const double &theta, const double &phi, const double &psi);
 
+	/** Set the orientation of the camera explicitly
+	  */
+	void setRotation(const quaternion &orientation);
+
 	/** Point the camera at a location in 3d space
 	  */
 	void lookAt(const vector3 &position);
@@ -122,28 +179,52 @@ public:
 
 	/** Render a single triangle by computing its projection onto the viewing plane
 	  * @param offset The offset of the object from the world origin
-	  * @param tri The triangles to render
+	  * @param verts Array of the three vertices of the triangle (relative to the object offset)
 	  * @param pixelX Array of horizontal coordinates for the three vertices (must contain at least 3 elements)
 	  * @param pixelY Array of vertical coordinates for the three vertices (must contain at least 3 elements)
+	  * @param sZ Array of normalized reciprocal depths for the three vertices (must contain at least 3 elements)
 	  * @param valid Array of boolean flags which indicates that each of the three vertices are in front of the ray (must contain at least 3 elements)
 	  */
-	void render(const vector3 &offset, const triangle &tri, double *sX, double *sY, bool *valid);
+	void render(const vector3 &offset, const vector3 *verts, double *sX, double *sY, double *sZ, bool *valid);
 
-	/** Check whether or not a triangle is facing towards the camera
-	  * @param offset The offset of the object from the world origin
-	  * @param tri The triangles to draw
-	  * @return True if the triangle is facing towards the camera and return false otherwise
+	/** Get the ray from the camera's position through a point on the screen
+	  * @param sX The horizontal position on the screen (in screen-space)
+	  * @param sY The vertical position on the screen (in screen-space)
+	  * @return A ray which every point along projects onto (sX, sY)
 	  */
-	bool checkCulling(const vector3 &offset, const triangle &tri);
+	ray getRay(const double &sX, const double &sY) const ;
+
+	/** Check whether or not a sphere lies at least partially inside the viewing frustum
+	  * @param center The center of the sphere (in real-space)
+	  * @param radius The radius of the sphere
+	  * @return False if the sphere lies entirely outside of at least one frustum plane and return true otherwise
+	  */
+	bool checkFrustum(const vector3 &center, const double &radius) const ;
+
+	/** Check whether or not an axis-aligned box lies at least partially inside the viewing frustum
+	  * @param boxMin The minimum corner of the box (in real-space)
+	  * @param boxMax The maximum corner of the box (in real-space)
+	  * @return False if the box lies entirely outside of at least one frustum plane and return true otherwise
+	  */
+	bool checkFrustum(const vector3 &boxMin, const vector3 &boxMax) const ;
 
 	/** Compute the coordinates where a ray from a vertex intersects the viewing plane
 	  * @param vertex The originating point of the ray (in real-space)
 	  * @param sX The horizontal component of the position where the ray intersects the viewing plane (in screen-space)
 	  * @param sY The vertical component of the position where the ray intersects the viewing plane (in screen-space)
-	  * @return True if the ray intersects the viewing plane, and reutrn false otherwise
+	  * @return True if the vertex lies in front of the viewing plane, and reutrn false otherwise
 	  */
 	bool projectPoint(const vector3 &vertex, double &sX, double &sY);
 
+	/** Compute the coordinates where a ray from a vertex intersects the viewing plane as well as the depth of the vertex
+	  * @param vertex The originating point of the ray (in real-space)
+	  * @param sX The horizontal component of the position where the ray intersects the viewing plane (in screen-space)
+	  * @param sY The vertical component of the position where the ray intersects the viewing plane (in screen-space)
+	  * @param sZ The normalized reciprocal depth of the vertex, L/z, where z is the distance from the camera along its viewing axis
+	  * @return True if the vertex lies in front of the viewing plane, and reutrn false otherwise
+	  */
+	bool projectPoint(const vector3 &vertex, double &sX, double &sY, double &sZ);
+
 	/** Dump camera parameters to stdout
 	  */
 	void dump() const ;
@@ -154,36 +235,43 @@ private:
 	double A; ///< Aspect ratio
 	double W; ///< Viewing plane width (in m)
 	double H; ///< Viewing plane height (in m)
+	double viewDistance; ///< Maximum distance along the viewing axis at which objects are drawn (in m)
 
 	plane vPlane; ///< The viewing plane of the camera
 	
 	vector3 pos; ///< The focal point of the camera (its position)
 	
-	vector3 uX; ///< Unit vector for the x-axis
-	vector3 uY; ///< Unit vector for the y-axis
-	vector3 uZ; ///< Unit vector for the z-axis
+	quaternion orient; ///< Orientation of the camera relative to the real-space axes
+	bool basisChanged; ///< Flag indicating that the unit vectors are out of date with the orientation
+
+	vector3 uX; ///< Unit vector for the x-axis (derived from the orientation)
+	vector3 uY; ///< Unit vector for the y-axis (derived from the orientation)
+	vector3 uZ; ///< Unit vector for the z-axis (derived from the orientation)
+
+	matrix4 view; ///< Transformation from real-space to the camera's reference frame
+	matrix4 proj; ///< Transformation from the camera's reference frame to clip-space
+	matrix4 viewProj; ///< Combined view and projection transformations
+
+	plane frustum[6]; ///< Planes bounding the viewing frustum, indexed by frustumPlane
 	
 	/** Initialize the camera by setting initial values and computing all geometric parameters
 	  */
 	void initialize();
 	
-	/** Compute the dimensions of the viewing plane based on the field-of-view, the focal-length,
-	  * and the aspect-ratio
+	/** Compute the dimensions of the viewing plane, and the projection matrix, based on the field-of-view,
+	  * the focal-length, and the aspect-ratio
 	  */
 	void computeViewingPlane();
 	
-	/** Update the central point and normal vector of the viewing plane
+	/** Update the central point and normal vector of the viewing plane as well as the view matrix
+	  * @note The unit vectors are recomputed from the orientation first, if it has changed
 	  */
 	void updateViewingPlane();
-	
-	/** Convert a real-space position on the viewing plane to a position in screen-space [-1, 1]
-	  * @note The origin of screen-space is the center of the screen with the positive x-direction
-	  *       being toward the right side of the screen and the positive y-direction being toward the top
-	  * @param vec The position on the surface of the viewing plane (in real-space)
-	  * @param x The horizontal component of the screen-space coordinate
-	  * @param y The vertical component of the screen-space coordinate
+
+	/** Rebuild the view-projection matrix from the current view and projection matrices and update the frustum planes
 	  */
-	void convertToScreenSpace(const vector3 &vec, double &x, double &y);
+	void updateViewProjection();
+	
 	
 	/** Trace a ray, from the camera position, through a point on the viewing plane to the surface-plane of an input triangle
 	  * @param sX The x-coordinate on the viewing plane through which the ray will be cast (in screen-space)
@@ -59,6 +59,10 @@ public:
 	  */
 	sdlColor& operator /= (const float &rhs);
 
+	/** Pack the color into a 32-bit ARGB8888 pixel value
+	  */
+	unsigned int toARGB(const float &alpha=1) const { return ((unsigned int)toUChar(alpha) << 24 | (unsigned int)r << 16 | (unsigned int)g << 8 | (unsigned int)b); }
+
 	/** Get the RGB inverse of this color
 	  */
 	sdlColor invert() const ;
@@ -80,6 +84,106 @@ public:
 	static float toFloat(const unsigned char &val){ return (float(val)/255); }
 };
 
+/** @class linearColor
+  * @brief Floating point RGBA color in linear light, used as the working format for shading math
+  *
+  * Components are not clamped, so one is full intensity but any number of lights may be summed or scaled without
+  * overflowing or losing precision. Colors are clamped and converted to 8 bits once, when they are written to a
+  * framebuffer, optionally with sRGB encoding. sdlColor remains the format in which colors are stored.
+  */
+
+class linearColor{
+public:
+	float r; ///< Red component
+	float g; ///< Green component
+	float b; ///< Blue component
+	float a; ///< Alpha component (opacity)
+
+	/** Default constructor (opaque black)
+	  */
+	linearColor() : r(0), g(0), b(0), a(1) { }
+
+	/** Grayscale constructor
+	  */
+	linearColor(const float &value) : r(value), g(value), b(value), a(1) { }
+
+	/** RGBA constructor
+	  */
+	linearColor(const float &red, const float &green, const float &blue, const float &alpha=1) : r(red), g(green), b(blue), a(alpha) { }
+
+	/** Stored color constructor. The 8-bit components are scaled to the range [0, 1] without decoding
+	  */
+	explicit linearColor(const sdlColor &color) : r(sdlColor::toFloat(color.r)), g(sdlColor::toFloat(color.g)), b(sdlColor::toFloat(color.b)), a(1) { }
+
+	/** Add a color to this color and return the result (the alpha of this color is kept)
+	  */
+	linearColor operator + (const linearColor &rhs) const { return linearColor(r+rhs.r, g+rhs.g, b+rhs.b, a); }
+
+	/** Subtract a color from this color and return the result (the alpha of this color is kept)
+	  */
+	linearColor operator - (const linearColor &rhs) const { return linearColor(r-rhs.r, g-rhs.g, b-rhs.b, a); }
+
+	/** Multiply this color by another, component by component, and return the result (e.g. to tint a light by the color of a surface)
+	  */
+	linearColor operator * (const linearColor &rhs) const { return linearColor(r*rhs.r, g*rhs.g, b*rhs.b, a*rhs.a); }
+
+	/** Multiply this color by a constant scaling factor and return the result (the alpha of this color is kept)
+	  */
+	linearColor operator * (const float &rhs) const { return linearColor(r*rhs, g*rhs, b*rhs, a); }
+
+	/** Divide this color by a constant scaling factor and return the result (the alpha of this color is kept)
+	  */
+	linearColor operator / (const float &rhs) const { return linearColor(r/rhs, g/rhs, b/rhs, a); }
+
+	/** Add a color to this color
+	  */
+	linearColor& operator += (const linearColor &rhs){ return ((*this) = (*this) + rhs); }
+
+	/** Subtract a color from this color
+	  */
+	linearColor& operator -= (const linearColor &rhs){ return ((*this) = (*this) - rhs); }
+
+	/** Multiply this color by another, component by component
+	  */
+	linearColor& operator *= (const linearColor &rhs){ return ((*this) = (*this) * rhs); }
+
+	/** Multiply this color by a constant scaling factor
+	  */
+	linearColor& operator *= (const float &rhs){ return ((*this) = (*this) * rhs); }
+
+	/** Divide this color by a constant scaling factor
+	  */
+	linearColor& operator /= (const float &rhs){ return ((*this) = (*this) / rhs); }
+
+	/** Clamp the color to the range [0, 1] and convert it to the storage format
+	  * @param srgb If set, the components are sRGB encoded rather than stored linearly
+	  */
+	sdlColor toColor(const bool &srgb=false) const ;
+
+	/** Clamp the color to the range [0, 1] and pack it into a 32-bit ARGB8888 pixel value
+	  * @param srgb If set, the color components are sRGB encoded rather than stored linearly (alpha is always linear)
+	  */
+	unsigned int toARGB(const bool &srgb=false) const ;
+
+	/** Get the linear color of a stored color whose components are sRGB encoded
+	  */
+	static linearColor fromSRGB(const sdlColor &color);
+
+	/** Encode a linear value in the range [0, 1] using the sRGB transfer function
+	  * @note Uses an approximation of the power curve built from square roots, which is within a quarter of an
+	  *       8-bit step of the exact curve and is evaluated the same way by the SIMD shading kernels
+	  */
+	static float encodeSRGB(const float &value);
+
+	/** Decode an sRGB encoded value in the range [0, 1] to linear light
+	  */
+	static float decodeSRGB(const float &value);
+
+	/** Clamp a value to the range [0, 1]
+	  */
+	static float clamp(const float &value){ return (value < 1 ? (value > 0 ? value : 0) : 1); }
+};
+
 namespace Colors{
 	const sdlColor BLACK(0, 0, 0);
 	const sdlColor WHITE(1, 1, 1);
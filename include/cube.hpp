@@ -1,18 +1,35 @@
 #ifndef CUBE_HPP
 #define CUBE_HPP
 
+#include <memory>
+
 #include "object.hpp"
 
 class cube : public object {
 public:
+	/** Box constructor
+	  * @note The mesh is shared with every other cube of the same size (see getBoxMesh())
+	  */
 	cube(const vector3 &pos_, const double &X, const double &Y, const double &Z);
 	
 	void build();
 	
+	/** Get the mesh of a box, centered on the origin, which is shared by every cube of the same size
+	  * @note The mesh is built the first time a size is requested, and freed once no object uses it
+	  * @param X The length of the box along the x-axis
+	  * @param Y The length of the box along the y-axis
+	  * @param Z The length of the box along the z-axis
+	  */
+	static std::shared_ptr<mesh> getBoxMesh(const double &X, const double &Y, const double &Z);
+
 private:
 	double hX;
 	double hY;
 	double hZ;
+
+	/** Add the vertices and polygons of a box, centered on the origin, to a mesh
+	  */
+	static void addBox(mesh &geometry, const double &halfX, const double &halfY, const double &halfZ);
 };
 
 #endif
@@ -0,0 +1,99 @@
+#ifndef DEPTH_BUFFER_HPP
+#define DEPTH_BUFFER_HPP
+
+#include <vector>
+#include <cstddef>
+
+/** @class depthBuffer
+  * @brief Per-pixel depth (z) buffer used to resolve the visibility of filled triangles
+  *
+  * Depth values are stored as the normalized reciprocal depth, q = L/z, where L is the focal
+  * length of the camera and z is the distance along the camera's viewing axis. This means that
+  * q is in the range (0, 1] for all points in front of the viewing plane, that larger values are
+  * closer to the camera, and that q may be linearly interpolated in screen-space.
+  */
+
+class depthBuffer{
+public:
+	/** Supported depth storage formats
+	  */
+	enum depthFormat {FLOAT32, ///< 32-bit floating point
+	                  FIXED16, ///< 16-bit unsigned fixed point
+	                  FIXED24  ///< 24-bit unsigned fixed point (stored in 32 bits)
+	};
+
+	/** Default constructor (empty 32-bit floating point buffer)
+	  */
+	depthBuffer() : W(0), H(0), format(FLOAT32), scale(1) { }
+
+	/** Constructor taking the width and height of the buffer (in pixels) and the storage format
+	  */
+	depthBuffer(const int &width, const int &height, const depthFormat &fmt=FLOAT32);
+
+	/** Get the width of the buffer (in pixels)
+	  */
+	int getWidth() const { return W; }
+
+	/** Get the height of the buffer (in pixels)
+	  */
+	int getHeight() const { return H; }
+
+	/** Get the storage format of the buffer
+	  */
+	depthFormat getFormat() const { return format; }
+
+	/** Get the factor used to convert a normalized depth in the range [0, 1] to a stored value
+	  */
+	float getScale() const { return scale; }
+
+	/** Get a pointer to the first element of a row of a 32-bit floating point buffer
+	  */
+	float* getRowFloat(const int &y){ return &dataFloat[(size_t)y*W]; }
+
+	/** Get a pointer to the first element of a row of a 16-bit fixed point buffer
+	  */
+	unsigned short* getRowFixed16(const int &y){ return &dataShort[(size_t)y*W]; }
+
+	/** Get a pointer to the first element of a row of a 24-bit fixed point buffer
+	  */
+	unsigned int* getRowFixed24(const int &y){ return &dataInt[(size_t)y*W]; }
+
+	/** Get the normalized depth of the pixel at position (x, y)
+	  */
+	float getDepth(const int &x, const int &y) const ;
+
+	/** Resize the buffer, discarding its contents
+	  */
+	void resize(const int &width, const int &height);
+
+	/** Set the storage format, discarding the contents of the buffer
+	  */
+	void setFormat(const depthFormat &fmt);
+
+	/** Reset every pixel to the farthest possible depth
+	  */
+	void clear();
+
+	/** Check the depth of a pixel against the buffer without modifying it
+	  * @param x The horizontal pixel coordinate
+	  * @param y The vertical pixel coordinate
+	  * @param q The normalized depth of the test point
+	  * @param bias Relative tolerance by which the test is relaxed (useful for drawing edges on top of filled triangles)
+	  * @return True if the test point is at least as close as the stored depth (within the tolerance) and return false otherwise
+	  */
+	bool test(const int &x, const int &y, const float &q, const float &bias=0) const ;
+
+private:
+	int W; ///< Width of the buffer (in pixels)
+	int H; ///< Height of the buffer (in pixels)
+
+	depthFormat format; ///< The storage format of the buffer
+
+	float scale; ///< Conversion factor from normalized depth to stored value
+
+	std::vector<float> dataFloat; ///< Depth storage for the 32-bit floating point format
+	std::vector<unsigned short> dataShort; ///< Depth storage for the 16-bit fixed point format
+	std::vector<unsigned int> dataInt; ///< Depth storage for the 24-bit fixed point format
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef FRAME_BUFFER_HPP
+#define FRAME_BUFFER_HPP
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include "colors.hpp"
+
+/** @class frameBuffer
+  * @brief CPU-side 32-bit (ARGB8888) color buffer which all 2d drawing routines write into directly
+  */
+
+class frameBuffer{
+public:
+	/** Default constructor (empty buffer)
+	  */
+	frameBuffer() : W(0), H(0), drawColor(0xFF000000) { }
+
+	/** Constructor taking the width and height of the buffer (in pixels)
+	  */
+	frameBuffer(const int &width, const int &height);
+
+	/** Get the width of the buffer (in pixels)
+	  */
+	int getWidth() const { return W; }
+
+	/** Get the height of the buffer (in pixels)
+	  */
+	int getHeight() const { return H; }
+
+	/** Get the number of bytes in a single row of the buffer
+	  */
+	int getPitch() const { return (int)(W*sizeof(unsigned int)); }
+
+	/** Get a pointer to the first pixel of the buffer
+	  */
+	const unsigned int* get() const { return (!pixels.empty() ? &pixels[0] : NULL); }
+
+	/** Get a pointer to the first pixel of the buffer
+	  */
+	unsigned int* get(){ return (!pixels.empty() ? &pixels[0] : NULL); }
+
+	/** Get a pointer to the first pixel of a row of the buffer
+	  */
+	unsigned int* getRow(const int &y){ return &pixels[(size_t)y*W]; }
+
+	/** Get the packed color of the pixel at position (x, y)
+	  */
+	unsigned int getPixel(const int &x, const int &y) const { return pixels[(size_t)y*W+x]; }
+
+	/** Get the current packed draw color
+	  */
+	unsigned int getDrawColor() const { return drawColor; }
+
+	/** Resize the buffer, discarding its contents
+	  */
+	void resize(const int &width, const int &height);
+
+	/** Set the current draw color
+	  */
+	void setDrawColor(const sdlColor &color, const float &alpha=1){ drawColor = color.toARGB(alpha); }
+
+	/** Set the current draw color using a packed ARGB8888 value
+	  */
+	void setDrawColor(const unsigned int &color){ drawColor = color; }
+
+	/** Fill the entire buffer with a color
+	  */
+	void clear(const sdlColor &color=Colors::BLACK);
+
+	/** Draw a single pixel at position (x, y)
+	  * @note Pixels which lie outside the buffer are ignored
+	  */
+	void drawPixel(const int &x, const int &y){
+		if(x >= 0 && x < W && y >= 0 && y < H)
+			pixels[(size_t)y*W+x] = drawColor;
+	}
+
+	/** Draw a horizontal line of pixels between x1 and x2 (inclusive) along row y
+	  * @note The line is clipped to the edges of the buffer
+	  */
+	void drawHorizontalLine(int x1, int x2, const int &y);
+
+	/** Draw a single line between points (x1, y1) and (x2, y2)
+	  * @note The line is clipped to the edges of the buffer
+	  */
+	void drawLine(const int &x1, const int &y1, const int &x2, const int &y2);
+
+	/** Write the contents of the buffer to a binary (P6) PPM image
+	  * @return True if the image was written successfully and return false otherwise
+	  */
+	bool write(const std::string &filename) const ;
+
+	/** Clip the line between (x1, y1) and (x2, y2) to the edges of the buffer
+	  * @return True if any part of the line lies inside the buffer and return false otherwise
+	  */
+	bool clipLine(int &x1, int &y1, int &x2, int &y2) const ;
+
+private:
+	int W; ///< Width of the buffer (in pixels)
+	int H; ///< Height of the buffer (in pixels)
+
+	unsigned int drawColor; ///< The current packed ARGB8888 draw color
+
+	std::vector<unsigned int> pixels; ///< Packed ARGB8888 pixels stored row by row, starting at the upper-left corner
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef HALF_SPACE_HPP
+#define HALF_SPACE_HPP
+
+#include "depthBuffer.hpp"
+
+/** @class halfSpaceTriangle
+  * @brief Edge function and depth plane setup for a triangle drawn by the half-space rasterizer
+  *
+  * Each of the three edge functions is E(x, y) = A*x + B*y + C, evaluated at the center of pixel (x, y).
+  * The vertices are ordered, and the fill rule folded into C, so that a pixel lies inside the triangle
+  * when all three are >= 0.
+  */
+
+class halfSpaceTriangle{
+public:
+	int A[3]; ///< Change in each edge function for a step of one pixel to the right
+	int B[3]; ///< Change in each edge function for a step of one pixel down
+	long long C[3]; ///< Each edge function evaluated at pixel (0, 0)
+
+	double qRefX; ///< Horizontal pixel index of the depth plane reference point (may be fractional)
+	double qRefY; ///< Vertical pixel index of the depth plane reference point (may be fractional)
+	double qRef; ///< Normalized reciprocal depth at the reference point
+	double dqdx; ///< Change in depth for a step of one pixel to the right
+	double dqdy; ///< Change in depth for a step of one pixel down
+
+	int minX; ///< Minimum horizontal pixel of the clipped bounding box
+	int minY; ///< Minimum vertical pixel of the clipped bounding box
+	int maxX; ///< One past the maximum horizontal pixel of the clipped bounding box
+	int maxY; ///< One past the maximum vertical pixel of the clipped bounding box
+
+	unsigned int color; ///< The packed ARGB8888 fill color
+};
+
+/** @class halfSpaceTarget
+  * @brief Color and depth buffers, and the region of them, which a half-space kernel may write into
+  */
+
+class halfSpaceTarget{
+public:
+	unsigned int *color; ///< Pointer to the first pixel of the color buffer
+	void *depth; ///< Pointer to the first element of the depth buffer
+
+	depthBuffer::depthFormat format; ///< The storage format of the depth buffer
+
+	float scale; ///< Conversion factor from normalized depth to stored depth value
+
+	int width; ///< Number of pixels in each row of the buffers
+
+	int clipMinX; ///< Minimum horizontal pixel which may be written
+	int clipMinY; ///< Minimum vertical pixel which may be written
+	int clipMaxX; ///< One past the maximum horizontal pixel which may be written
+	int clipMaxY; ///< One past the maximum vertical pixel which may be written
+};
+
+/** Half-space kernel which draws a single triangle into a target
+  */
+typedef void (*halfSpaceKernel)(const halfSpaceTriangle &tri, const halfSpaceTarget &target);
+
+/** Draw a triangle using one pixel at a time (available on all platforms)
+  */
+void fillHalfSpaceScalar(const halfSpaceTriangle &tri, const halfSpaceTarget &target);
+
+/** Draw a triangle using SSE2 on 4x4 pixel blocks
+  * @note Falls back to the scalar kernel if the library was built without SSE2 support
+  */
+void fillHalfSpaceSSE2(const halfSpaceTriangle &tri, const halfSpaceTarget &target);
+
+/** Draw a triangle using AVX2 on 8x8 pixel blocks
+  * @note Falls back to the scalar kernel if the library was built without AVX2 support
+  */
+void fillHalfSpaceAVX2(const halfSpaceTriangle &tri, const halfSpaceTarget &target);
+
+/** Return true if the SSE2 kernel was compiled into the library and return false otherwise
+  */
+bool halfSpaceSSE2Compiled();
+
+/** Return true if the AVX2 kernel was compiled into the library and return false otherwise
+  */
+bool halfSpaceAVX2Compiled();
+
+/////////////////////////////////////////////////
+// Kernel implementation
+/////////////////////////////////////////////////
+
+// Everything below is instantiated separately in each kernel's translation unit, which may be
+//  compiled with different instruction set flags. All functions therefore have internal linkage
+//  so that the linker can never substitute one unit's (e.g. AVX2) code for another's.
+
+/** Clamp a 64-bit edge function value into 32 bits. Values this far from zero cannot change
+  *  sign within a single block, so only their magnitude is lost
+  */
+static inline int clampEdge(const long long &value){
+	const long long limit = 0x40000000LL;
+	return (int)(value > limit ? limit : (value < -limit ? -limit : value));
+}
+
+/** Test and write a single pixel
+  */
+template <typename T>
+static inline void halfSpacePixel(T *depthRow, unsigned int *colorRow, const int &x, float q, const float &scale, const unsigned int &color){
+	q = (q < 0 ? 0 : (q > 1 ? 1 : q));
+	T value = (T)(q*scale);
+	if(value > depthRow[x]){
+		depthRow[x] = value;
+		colorRow[x] = color;
+	}
+}
+
+/** Draw the part of a block which lies inside the clipping region, one pixel at a time
+  */
+template <typename T>
+static void halfSpaceBlockScalar(const halfSpaceTriangle &tri, const halfSpaceTarget &target, T *depth, const int &bx, const int &by, const int &size){
+	int x0 = (bx > target.clipMinX ? bx : target.clipMinX);
+	int y0 = (by > target.clipMinY ? by : target.clipMinY);
+	int x1 = (bx+size < target.clipMaxX ? bx+size : target.clipMaxX);
+	int y1 = (by+size < target.clipMaxY ? by+size : target.clipMaxY);
+	for(int y = y0; y < y1; y++){
+		T *depthRow = &depth[(size_t)y*target.width];
+		unsigned int *colorRow = &target.color[(size_t)y*target.width];
+		long long e0 = tri.C[0] + (long long)tri.A[0]*x0 + (long long)tri.B[0]*y;
+		long long e1 = tri.C[1] + (long long)tri.A[1]*x0 + (long long)tri.B[1]*y;
+		long long e2 = tri.C[2] + (long long)tri.A[2]*x0 + (long long)tri.B[2]*y;
+		float q = (float)(tri.qRef + tri.dqdx*(x0-tri.qRefX) + tri.dqdy*(y-tri.qRefY));
+		float dq = (float)tri.dqdx;
+		for(int x = x0; x < x1; x++, e0 += tri.A[0], e1 += tri.A[1], e2 += tri.A[2], q += dq){
+			if((e0 | e1 | e2) >= 0)
+				halfSpacePixel(depthRow, colorRow, x, q, target.scale, tri.color);
+		}
+	}
+}
+
+/** Draw a triangle by stepping over square blocks of pixels. Blocks which lie entirely outside
+  *  the triangle are rejected using their corners, and blocks which lie entirely inside skip
+  *  the per-pixel edge tests
+  * @param V Vector kernel class which provides the block size (V::SIZE) and a static method
+  *          V::block() to draw one block lying completely inside of the clipping region
+  */
+template <class V, typename T>
+static void halfSpaceFill(const halfSpaceTriangle &tri, const halfSpaceTarget &target, T *depth){
+	const int S = V::SIZE;
+
+	// Clip the bounding box to the target and align it to the block grid
+	int startX = (tri.minX > target.clipMinX ? tri.minX : target.clipMinX) & ~(S-1);
+	int startY = (tri.minY > target.clipMinY ? tri.minY : target.clipMinY) & ~(S-1);
+	int stopX = (tri.maxX < target.clipMaxX ? tri.maxX : target.clipMaxX);
+	int stopY = (tri.maxY < target.clipMaxY ? tri.maxY : target.clipMaxY);
+	for(int by = startY; by < stopY; by += S){
+		for(int bx = startX; bx < stopX; bx += S){
+			// Evaluate the edge functions at the upper-left corner of the block
+			long long e[3];
+			bool reject = false;
+			bool accept = true;
+			for(int i = 0; i < 3; i++){
+				e[i] = tri.C[i] + (long long)tri.A[i]*bx + (long long)tri.B[i]*by;
+
+				// Find the largest and smallest values over the four corners
+				long long dx = (long long)tri.A[i]*(S-1);
+				long long dy = (long long)tri.B[i]*(S-1);
+				long long emax = e[i] + (dx > 0 ? dx : 0) + (dy > 0 ? dy : 0);
+				long long emin = e[i] + (dx < 0 ? dx : 0) + (dy < 0 ? dy : 0);
+				if(emax < 0){ // Entire block is outside this edge
+					reject = true;
+					break;
+				}
+				if(emin < 0)
+					accept = false;
+			}
+			if(reject)
+				continue;
+
+			if(bx < target.clipMinX || by < target.clipMinY || bx+S > target.clipMaxX || by+S > target.clipMaxY){
+				// Block straddles the edge of the clipping region
+				halfSpaceBlockScalar(tri, target, depth, bx, by, S);
+				continue;
+			}
+
+			float q = (float)(tri.qRef + tri.dqdx*(bx-tri.qRefX) + tri.dqdy*(by-tri.qRefY));
+			V::block(tri, target, depth, bx, by, clampEdge(e[0]), clampEdge(e[1]), clampEdge(e[2]), q, accept);
+		}
+	}
+}
+
+/** Dispatch a half-space fill based on the depth buffer format
+  */
+template <class V>
+static void halfSpaceDispatch(const halfSpaceTriangle &tri, const halfSpaceTarget &target){
+	switch(target.format){
+		case depthBuffer::FIXED16:
+			halfSpaceFill<V>(tri, target, (unsigned short*)target.depth);
+			break;
+		case depthBuffer::FIXED24:
+			halfSpaceFill<V>(tri, target, (unsigned int*)target.depth);
+			break;
+		default:
+			halfSpaceFill<V>(tri, target, (float*)target.depth);
+			break;
+	}
+}
+
+#endif
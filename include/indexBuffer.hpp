@@ -0,0 +1,102 @@
+#ifndef INDEX_BUFFER_HPP
+#define INDEX_BUFFER_HPP
+
+#include <vector>
+
+/** @class indexBuffer
+  * @brief List of vertex indices stored using the smallest index type which is able to address every vertex
+  *
+  * Indices are stored using 16 bits until an index larger than 65535 is added, at which point the whole
+  * buffer is widened to 32 bits. Use getFormat() to select the matching raw array for sequential traversal.
+  */
+
+class indexBuffer{
+public:
+	/** Width of the stored indices
+	  */
+	enum indexFormat {INDEX_16, ///< Indices are stored as unsigned short
+	                  INDEX_32  ///< Indices are stored as unsigned int
+	};
+
+	/** Default constructor (empty 16-bit buffer)
+	  */
+	indexBuffer() : format(INDEX_16) { }
+
+	/** Get the width of the stored indices
+	  */
+	indexFormat getFormat() const { return format; }
+
+	/** Get the number of indices in the buffer
+	  */
+	size_t size() const { return (format == INDEX_16 ? shortIndices.size() : intIndices.size()); }
+
+	/** Return true if the buffer contains no indices and return false otherwise
+	  */
+	bool empty() const { return (size() == 0); }
+
+	/** Get the size of a single index (in bytes)
+	  */
+	size_t getIndexSize() const { return (format == INDEX_16 ? sizeof(unsigned short) : sizeof(unsigned int)); }
+
+	/** Get a pointer to the array of 16-bit indices
+	  * @note Returns NULL unless the format is INDEX_16
+	  */
+	const unsigned short* getShortIndices() const { return (format == INDEX_16 && !shortIndices.empty() ? &shortIndices[0] : NULL); }
+
+	/** Get a pointer to the array of 32-bit indices
+	  * @note Returns NULL unless the format is INDEX_32
+	  */
+	const unsigned int* getIntIndices() const { return (format == INDEX_32 && !intIndices.empty() ? &intIndices[0] : NULL); }
+
+	/** Get a single index from the buffer
+	  */
+	unsigned int operator [] (const size_t &index) const { return (format == INDEX_16 ? shortIndices[index] : intIndices[index]); }
+
+	/** Add an index to the end of the buffer, widening the buffer to 32 bits if the index does not fit in 16 bits
+	  */
+	void push_back(const unsigned int &index){
+		if(format == INDEX_16 && index > 0xFFFF)
+			widen();
+		if(format == INDEX_16)
+			shortIndices.push_back((unsigned short)index);
+		else
+			intIndices.push_back(index);
+	}
+
+	/** Make sure the buffer is able to hold a given number of indices without reallocating
+	  * @param count The number of indices
+	  * @param maxIndex The largest index which will be added. The buffer is widened now if it does not fit in 16 bits
+	  */
+	void reserve(const size_t &count, const unsigned int &maxIndex=0){
+		if(format == INDEX_16 && maxIndex > 0xFFFF)
+			widen();
+		if(format == INDEX_16)
+			shortIndices.reserve(count);
+		else
+			intIndices.reserve(count);
+	}
+
+	/** Remove all indices from the buffer and return it to 16-bit storage
+	  */
+	void clear(){
+		shortIndices.clear();
+		intIndices.clear();
+		format = INDEX_16;
+	}
+
+private:
+	indexFormat format; ///< Width of the stored indices
+
+	std::vector<unsigned short> shortIndices; ///< Indices while the format is INDEX_16
+	std::vector<unsigned int> intIndices; ///< Indices while the format is INDEX_32
+
+	/** Convert all stored indices to 32 bits
+	  */
+	void widen(){
+		intIndices.assign(shortIndices.begin(), shortIndices.end());
+		std::vector<unsigned short>().swap(shortIndices);
+		format = INDEX_32;
+	}
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef INSTANCE_HPP
+#define INSTANCE_HPP
+
+#include "object.hpp"
+
+/** @class instance
+  * @brief Object which draws a mesh shared with other objects, with its own transform, drawing mode, and color
+  *
+  * Instances hold a reference to the mesh rather than a copy of it, so any number of them may be placed in a
+  * scene for the memory cost of one mesh. The scene draws all visible instances of a mesh together.
+  *
+  * An instance is still a complete object, so that it may be culled, ray-cast, and shaded like any other. Each one
+  * costs the object itself, its bounding volume hierarchy leaf, and one cached color per triangle once it is shaded.
+  */
+
+class instance : public object {
+public:
+	/** Shared mesh constructor
+	  * @param geometry_ The mesh to draw
+	  * @param pos_ The position offset of the instance
+	  */
+	instance(const std::shared_ptr<mesh> &geometry_, const vector3 &pos_) : object(geometry_, pos_) { }
+
+	/** Source object constructor
+	  * @param source The object whose mesh, drawing mode, and color are used by the instance
+	  * @param pos_ The position offset of the instance
+	  */
+	instance(const object &source, const vector3 &pos_) : object(source.getSharedMesh(), pos_) {
+		setDrawingMode(source.getDrawingMode());
+		setColor(source.getColor());
+	}
+
+	/** The mesh is built by its owner, so there is nothing to do
+	  */
+	void build(){ }
+};
+
+#endif
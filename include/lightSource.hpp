@@ -1,40 +1,128 @@
 #ifndef LIGHT_SOURCE_HPP
 #define LIGHT_SOURCE_HPP
 
+#include <limits>
+
 #include "colors.hpp"
 #include "ray.hpp"
+#include "matrix3.hpp"
+#include "vertexArray.hpp"
 
 class plane;
+class camera;
+
+const double DIRECTIONAL_SHADOW_DISTANCE = 50; ///< Distance of the shadow camera of a directional light from the scene, in units of the radius of the scene
 
 class lightSource : public ray {
 public:
-	lightSource() : ray(vector3(0, 0, 0), vector3(0, 0, 1)), brightness(1), color(Colors::WHITE) { }
+	lightSource() : ray(vector3(0, 0, 0), vector3(0, 0, 1)), brightness(1), range(std::numeric_limits<float>::max()), color(Colors::WHITE), castShadows(false), revision(0) { }
+
+	/** Destructor
+	  */
+	virtual ~lightSource(){ }
 
 	/** Get the brightness of the light source
 	  */
 	float getBrightness() const { return brightness; }
+
+	/** Get the distance from the light source beyond which surfaces receive no light (in m)
+	  */
+	float getRange() const { return range; }
 	
 	/** Get the color of the light source
 	  */
 	sdlColor getColor() const { return color; }
 	
+	/** Return true if the light source casts shadows in RENDER mode and return false otherwise
+	  */
+	bool getCastShadows() const { return castShadows; }
+
+	/** Get the number of times the light source has been changed through its setters
+	  * @note Scenes compare revision numbers to decide when cached shading is out of date. Changes made directly to
+	  *       the position or direction members are not counted
+	  */
+	unsigned int getRevision() const { return revision; }
+
 	/** Get the scaled color of the light source based on the angle between the direction of the
 	  * light source and the normal to a surface
+	  * @note The color is not clamped, so the light from several sources may be summed before it is stored
 	  */
-	sdlColor getColor(const plane *surface) const { return (color * getIntensity(surface)); }
+	linearColor getColor(const plane *surface) const { return (linearColor(color) * getIntensity(surface)); }
 
 	/** Set the brightness of the light source
 	  */
-	void setBrightness(const float &brightness_){ brightness = brightness_; }
+	void setBrightness(const float &brightness_){
+		brightness = brightness_;
+		revision++;
+	}
+
+	/** Set the distance from the light source beyond which surfaces receive no light (in m)
+	  * @note Has no effect on directional lights, which light the whole scene
+	  */
+	void setRange(const float &range_){
+		range = range_;
+		revision++;
+	}
 
 	/** Set the color of the light source
 	  */
-	void setColor(const sdlColor &color_){ color = color_; }
+	void setColor(const sdlColor &color_){
+		color = color_;
+		revision++;
+	}
+
+	/** Enable or disable shadows cast by this light source in RENDER mode
+	  * @note Only directional and cone lights are able to cast shadows
+	  */
+	void setCastShadows(const bool &enable=true){
+		castShadows = enable;
+		revision++;
+	}
+
+	/** Set the position of the light source (in real-space)
+	  */
+	void setPosition(const vector3 &position){
+		pos = position;
+		revision++;
+	}
+
+	/** Set the direction of the light rays (or the axis of a cone light)
+	  */
+	void setDirection(const vector3 &direction){
+		dir = direction;
+		revision++;
+	}
+
+	/** Return true if the light source may reach any point inside a sphere and return false if it cannot
+	  * @param center The center of the sphere (in real-space)
+	  * @param radius The radius of the sphere
+	  */
+	virtual bool illuminates(const vector3 &center, const double &radius) const { return true; }
+
+	/** Get the light source in the form used by the shading kernels, in the reference frame of an object
+	  * @param offset The position of the object (in real-space)
+	  * @param rotation The rotation of the object, which is undone to move the light into object-space
+	  */
+	virtual faceLight getFaceLight(const vector3 &offset, const matrix3 &rotation) const ;
+
+	/** Aim a camera so that it sees everything which the light source is able to shadow, for drawing a shadow map
+	  * @param cam The camera to aim
+	  * @param sceneMin The minimum corner of the box which bounds every object of the scene (in real-space)
+	  * @param sceneMax The maximum corner of the box which bounds every object of the scene (in real-space)
+	  * @return True if the camera was aimed and return false if the light source is unable to cast shadows
+	  */
+	virtual bool getShadowCamera(camera &cam, const vector3 &sceneMin, const vector3 &sceneMax) const { return false; }
 
 protected:
 	float brightness; ///< The brightness of the light source
 
+	float range; ///< The distance from the light source beyond which surfaces receive no light (in m)
+
 	sdlColor color; ///< The color of the light source
+
+	bool castShadows; ///< Flag indicating that the light source casts shadows
+
+	unsigned int revision; ///< The number of times the light source has been changed
 	
 	/** Get the intensity scaling factor based on the angle between the direction of the
 	  * light source and the normal to a surface
@@ -47,6 +135,12 @@ public:
 	/** Default constructor
 	  */
 	directionalLight() : lightSource() { }
+
+	/** Aim a camera along the light direction at the center of the scene, from far enough away that its rays are nearly parallel
+	  * @note The camera only has a perspective projection, so it is placed DIRECTIONAL_SHADOW_DISTANCE times the radius
+	  *       of the scene away, where the directions of its rays differ by no more than about one degree
+	  */
+	bool getShadowCamera(camera &cam, const vector3 &sceneMin, const vector3 &sceneMax) const ;
 };
 
 class pointLight : public lightSource {
@@ -55,10 +149,18 @@ public:
 	  */
 	pointLight() : lightSource() { }
 
+	/** Return true if the sphere is at least partially within range of the light and return false otherwise
+	  */
+	bool illuminates(const vector3 &center, const double &radius) const ;
+
+	/** Get the light source in the form used by the shading kernels, in the reference frame of an object
+	  */
+	faceLight getFaceLight(const vector3 &offset, const matrix3 &rotation) const ;
+
 protected:
-	/** Get the intensity scaling factor based on the angle between the direction of the
-	  * light source and the normal to a surface as well as the distance from the point
-	  * to the light position
+	/** Get the intensity scaling factor based on the angle between the direction from the
+	  * light position to a surface and the normal to the surface as well as the distance from
+	  * the surface to the light position
 	  */
 	float getIntensity(const plane *surface) const ;
 };
@@ -68,13 +170,38 @@ public:
 	/** Default constructor
 	  */
 	coneLight() : lightSource(), openingAngle(0.5236) { }
+
+	/** Get the opening angle of the light cone (in radians)
+	  */
+	float getOpeningAngle() const { return openingAngle; }
+
+	/** Set the opening angle of the light cone (in radians)
+	  */
+	void setOpeningAngle(const float &angle){
+		openingAngle = angle;
+		revision++;
+	}
+
+	/** Return true if the sphere is at least partially within range of the light and inside the light cone and
+	  * return false otherwise
+	  */
+	bool illuminates(const vector3 &center, const double &radius) const ;
+
+	/** Get the light source in the form used by the shading kernels, in the reference frame of an object
+	  */
+	faceLight getFaceLight(const vector3 &offset, const matrix3 &rotation) const ;
+
+	/** Aim a camera from the position of the light along the axis of the cone, with a field-of-view equal to the opening angle
+	  * @note Cones which open by 180 degrees or more are unable to cast shadows
+	  */
+	bool getShadowCamera(camera &cam, const vector3 &sceneMin, const vector3 &sceneMax) const ;
 	
 protected:
 	float openingAngle; ///< The opening angle of the light cone (in radians)
 
-	/** Get the intensity scaling factor based on the angle between the direction of the
-	  * light source and the normal to a surface as well as the distance from the test point
-	  * to the light position. The angle between the test point and the direction of the cone
+	/** Get the intensity scaling factor based on the angle between the direction from the
+	  * light position to a surface and the normal to the surface as well as the distance from
+	  * the surface to the light position. The angle between the test point and the direction of the cone
 	  * is checked against the opening angle of the light source, with any points lying outside
 	  * the cone being given an intensity of zero
 	  */
@@ -1,135 +1,237 @@
-#ifndef MATRIX3_HPP
-#define MATRIX3_HPP
-
-#include <string>
-
-#include "vector3.hpp"
-
-class matrix3{
-public:
-	double elements[3][3]; ///< All elements of the matrix stored using [col][row]
-
-	/** Default constructor
-	  */
-	matrix3();
-
-	/** Rotation matrix constructor
-	  */
-	matrix3(const vector3 &vec);
-
-	/** Rotation matrix constructor
-	  */
-	matrix3(const double &theta, const double &phi, const double &psi);
-
-	/** Explicit matrix element constructor
-	  */
-	matrix3(const double &a00, const double &a10, const double &a20,
-	        const double &a01, const double &a11, const double &a21,
-	        const double &a02, const double &a12, const double &a22);
-
-	/** Copy constructor
-	  */
-	matrix3(const matrix3 &other);
-
-	/** Assignment operator
-	  */
-	matrix3& operator = (const matrix3 &rhs);
-
-	/** Multiply this matrix by another matrix and return the resulting matrix
-	  */
-	matrix3 operator * (const matrix3 &rhs) const ;
-
-	/** Multiply this matrix by a constant and return the resulting matrix
-	  */
-	matrix3 operator * (const double &rhs) const ;
-
-	/** Multiply this matrix by a vector and return the resulting vector
-	  */
-	vector3 operator * (const vector3 &rhs) const ;
-
-	/** Divide this matrix by a constant and return the result
-	  */
-	matrix3 operator / (const double &rhs) const ;
-
-	/** Add a matrix to this one and return the result
-	  */
-	matrix3 operator + (const matrix3 &rhs) const ;
-
-	/** Subtract a matrix from this one and return the result
-	  */
-	matrix3 operator - (const matrix3 &rhs) const ;
-
-	/** Multiply this matrix by another matrix and return the result
-	  */
-	matrix3& operator *= (const matrix3 &rhs);
-
-	/** Multiply this matrix by a constant and return the result
-	  */	
-	matrix3& operator *= (const double &rhs); 
-
-	/** Divide this matrix by a constant and return the result
-	  */
-	matrix3& operator /= (const double &rhs);
-
-	/** Add a matrix to this one and return the result
-	  */
-	matrix3& operator += (const matrix3 &rhs);
-
-	/** Subtract a matrix from this one and return the result
-	  */
-	matrix3& operator -= (const matrix3 &rhs);
-
-	/** Get one row from the matrix
-	  */
-	void getRow(const size_t &row, vector3 &vec) const ;
-
-	/** Get one row from the matrix
-	  */
-	vector3 getRow(const size_t &row) const ;
-
-	/** Set one row in the matrix using a vector
-	  */
-	void setRow(const size_t &row, const vector3 &vec);
-
-	/** Set one row in the matrix explicitly
-	  */
-	void setRow(const size_t &row, const double &p1, const double &p2, const double &p3);
-
-	/** Set this to a rotation matrix using a vector whose three coordinates are equal to theta, phi and psi respectively (all in radians)
-	  */
-	void setRotation(const vector3 &vec);
-
-	/** Set this to a rotation matrix using theta, phi and psi (all in radians)
-	  */
-	void setRotation(const double &theta, const double &phi, const double &psi);
-
-	static matrix3 getPitchMatrix(const double &angle);
-	
-	static matrix3 getRollMatrix(const double &angle);
-	
-	static matrix3 getYawMatrix(const double &angle);
-
-	/** Operate on an input vector by multiplying it with this matrix
-	  */
-	void transform(vector3 &vec) const ;
-
-	/** Operate on an input vector by multiplying it with the transpose of this matrix
-	  */
-	void transpose(vector3 &vec) const ;
-
-	/** Dump all matrix elements into a returned string
-	  */
-	std::string dump();
-
-	/** Zero all elements of this matrix
-	  */	
-	void zero();
-
-	/** Set this matrix to an identity matrix (i.e. diagonal elements are equal to 1 and off-diagonal elements are equal to zero)
-	  */
-	void identity();
-};
-
-extern const matrix3 identityMatrix;
-
-#endif
+#ifndef MATRIX3_HPP
+#define MATRIX3_HPP
+
+#include <string>
+
+#include "vector3.hpp"
+
+/** @class matrix3T
+  * @brief 3x3 matrix with a given scalar type
+  *
+  * Arithmetic and vector transforms are defined in this header so that they may be inlined everywhere.
+  * Use the matrix3 (double) alias for scene-level math and the matrix3f (float) alias on the render path.
+  */
+
+template <typename T>
+class matrix3T{
+public:
+	T elements[3][3]; ///< All elements of the matrix stored using [col][row]
+
+	/** Default constructor
+	  */
+	constexpr matrix3T() : elements{{0, 0, 0}, {0, 0, 0}, {0, 0, 0}} { }
+
+	/** Rotation matrix constructor
+	  */
+	matrix3T(const vector3T<T> &vec){
+		setRotation(vec);
+	}
+
+	/** Rotation matrix constructor
+	  */
+	matrix3T(const T &theta, const T &phi, const T &psi){
+		setRotation(theta, phi, psi);
+	}
+
+	/** Explicit matrix element constructor
+	  */
+	constexpr matrix3T(const T &a00, const T &a10, const T &a20,
+	                   const T &a01, const T &a11, const T &a21,
+	                   const T &a02, const T &a12, const T &a22) : elements{{a00, a01, a02}, {a10, a11, a12}, {a20, a21, a22}} { }
+
+	/** Conversion constructor from a matrix with a different scalar type
+	  */
+	template <typename U>
+	explicit matrix3T(const matrix3T<U> &other){
+		for(unsigned int i = 0; i < 3; i++){ // Over columns
+			for(unsigned int j = 0; j < 3; j++){ // Over rows
+				elements[i][j] = (T)other.elements[i][j];
+			}
+		}
+	}
+
+	/** Multiply this matrix by another matrix and return the resulting matrix
+	  */
+	matrix3T operator * (const matrix3T &rhs) const {
+		matrix3T retval;
+		for(unsigned int i = 0; i < 3; i++){ // Over columns
+			for(unsigned int j = 0; j < 3; j++){ // Over rows
+				for(unsigned int k = 0; k < 3; k++){
+					retval.elements[i][j] += elements[i][k]*rhs.elements[k][j];
+				}
+			}
+		}
+		return retval;
+	}
+
+	/** Multiply this matrix by a constant and return the resulting matrix
+	  */
+	matrix3T operator * (const T &rhs) const {
+		matrix3T retval(*this);
+		return (retval *= rhs);
+	}
+
+	/** Multiply this matrix by a vector and return the resulting vector
+	  */
+	constexpr vector3T<T> operator * (const vector3T<T> &rhs) const {
+		return vector3T<T>(elements[0][0]*rhs.x + elements[0][1]*rhs.y + elements[0][2]*rhs.z,
+		                   elements[1][0]*rhs.x + elements[1][1]*rhs.y + elements[1][2]*rhs.z,
+		                   elements[2][0]*rhs.x + elements[2][1]*rhs.y + elements[2][2]*rhs.z);
+	}
+
+	/** Divide this matrix by a constant and return the result
+	  */
+	matrix3T operator / (const T &rhs) const {
+		matrix3T retval(*this);
+		return (retval /= rhs);
+	}
+
+	/** Add a matrix to this one and return the result
+	  */
+	matrix3T operator + (const matrix3T &rhs) const {
+		matrix3T retval(*this);
+		return (retval += rhs);
+	}
+
+	/** Subtract a matrix from this one and return the result
+	  */
+	matrix3T operator - (const matrix3T &rhs) const {
+		matrix3T retval(*this);
+		return (retval -= rhs);
+	}
+
+	/** Multiply this matrix by another matrix and return the result
+	  */
+	matrix3T& operator *= (const matrix3T &rhs){
+		return ((*this) = (*this)*rhs);
+	}
+
+	/** Multiply this matrix by a constant and return the result
+	  */
+	matrix3T& operator *= (const T &rhs){
+		for(unsigned int i = 0; i < 3; i++){ // Over columns
+			for(unsigned int j = 0; j < 3; j++){ // Over rows
+				elements[i][j] *= rhs;
+			}
+		}
+		return (*this);
+	}
+
+	/** Divide this matrix by a constant and return the result
+	  */
+	matrix3T& operator /= (const T &rhs){
+		for(unsigned int i = 0; i < 3; i++){ // Over columns
+			for(unsigned int j = 0; j < 3; j++){ // Over rows
+				elements[i][j] /= rhs;
+			}
+		}
+		return (*this);
+	}
+
+	/** Add a matrix to this one and return the result
+	  */
+	matrix3T& operator += (const matrix3T &rhs){
+		for(unsigned int i = 0; i < 3; i++){ // Over columns
+			for(unsigned int j = 0; j < 3; j++){ // Over rows
+				elements[i][j] += rhs.elements[i][j];
+			}
+		}
+		return (*this);
+	}
+
+	/** Subtract a matrix from this one and return the result
+	  */
+	matrix3T& operator -= (const matrix3T &rhs){
+		for(unsigned int i = 0; i < 3; i++){ // Over columns
+			for(unsigned int j = 0; j < 3; j++){ // Over rows
+				elements[i][j] -= rhs.elements[i][j];
+			}
+		}
+		return (*this);
+	}
+
+	/** Get one row from the matrix
+	  */
+	void getRow(const size_t &row, vector3T<T> &vec) const {
+		vec.x = elements[0][row]; vec.y = elements[1][row]; vec.z = elements[2][row];
+	}
+
+	/** Get one row from the matrix
+	  */
+	constexpr vector3T<T> getRow(const size_t &row) const {
+		return vector3T<T>(elements[0][row], elements[1][row], elements[2][row]);
+	}
+
+	/** Set one row in the matrix using a vector
+	  */
+	void setRow(const size_t &row, const vector3T<T> &vec){
+		elements[0][row] = vec.x; elements[1][row] = vec.y; elements[2][row] = vec.z;
+	}
+
+	/** Set one row in the matrix explicitly
+	  */
+	void setRow(const size_t &row, const T &p1, const T &p2, const T &p3){
+		elements[0][row] = p1; elements[1][row] = p2; elements[2][row] = p3;
+	}
+
+	/** Set this to a rotation matrix using a vector whose three coordinates are equal to theta, phi and psi respectively (all in radians)
+	  */
+	void setRotation(const vector3T<T> &vec){
+		setRotation(vec.x, vec.y, vec.z);
+	}
+
+	/** Set this to a rotation matrix using theta, phi and psi (all in radians)
+	  */
+	void setRotation(const T &theta, const T &phi, const T &psi);
+
+	static matrix3T getPitchMatrix(const T &angle);
+
+	static matrix3T getRollMatrix(const T &angle);
+
+	static matrix3T getYawMatrix(const T &angle);
+
+	/** Operate on an input vector by multiplying it with this matrix
+	  */
+	void transform(vector3T<T> &vec) const {
+		T x = vec.x, y = vec.y, z = vec.z;
+		vec.x = elements[0][0]*x + elements[0][1]*y + elements[0][2]*z;
+		vec.y = elements[1][0]*x + elements[1][1]*y + elements[1][2]*z;
+		vec.z = elements[2][0]*x + elements[2][1]*y + elements[2][2]*z;
+	}
+
+	/** Operate on an input vector by multiplying it with the transpose of this matrix
+	  */
+	void transpose(vector3T<T> &vec) const {
+		T x = vec.x, y = vec.y, z = vec.z;
+		vec.x = elements[0][0]*x + elements[1][0]*y + elements[2][0]*z;
+		vec.y = elements[0][1]*x + elements[1][1]*y + elements[2][1]*z;
+		vec.z = elements[0][2]*x + elements[1][2]*y + elements[2][2]*z;
+	}
+
+	/** Dump all matrix elements into a returned string
+	  */
+	std::string dump() const ;
+
+	/** Zero all elements of this matrix
+	  */
+	void zero(){
+		(*this) = matrix3T();
+	}
+
+	/** Set this matrix to an identity matrix (i.e. diagonal elements are equal to 1 and off-diagonal elements are equal to zero)
+	  */
+	void identity(){
+		(*this) = matrix3T(1, 0, 0,
+		                   0, 1, 0,
+		                   0, 0, 1);
+	}
+};
+
+typedef matrix3T<double> matrix3; ///< Double precision matrix used for scene-level math
+typedef matrix3T<float> matrix3f; ///< Single precision matrix used on the render path
+
+constexpr matrix3 identityMatrix(1, 0, 0,
+                                 0, 1, 0,
+                                 0, 0, 1);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef MATRIX4_HPP
+#define MATRIX4_HPP
+
+#include <string>
+
+#include "vector3.hpp"
+#include "matrix3.hpp"
+
+/** @class matrix4
+  * @brief 4x4 matrix used for homogeneous transformations of 3d points
+  */
+
+class matrix4{
+public:
+	double elements[4][4]; ///< All elements of the matrix stored using [row][col]
+
+	/** Default constructor (zero matrix)
+	  */
+	matrix4();
+
+	/** Explicit matrix element constructor (elements given row by row)
+	  */
+	matrix4(const double &a00, const double &a01, const double &a02, const double &a03,
+	        const double &a10, const double &a11, const double &a12, const double &a13,
+	        const double &a20, const double &a21, const double &a22, const double &a23,
+	        const double &a30, const double &a31, const double &a32, const double &a33);
+
+	/** Multiply this matrix by another matrix and return the resulting matrix
+	  */
+	matrix4 operator * (const matrix4 &rhs) const ;
+
+	/** Multiply this matrix by another matrix and return the result
+	  */
+	matrix4& operator *= (const matrix4 &rhs);
+
+	/** Set one row in the matrix explicitly
+	  */
+	void setRow(const size_t &row, const double &p0, const double &p1, const double &p2, const double &p3);
+
+	/** Transform a point, with an implicit homogeneous coordinate of 1, by multiplying it with this matrix
+	  * @param vec The input point
+	  * @param x The x-component of the transformed point
+	  * @param y The y-component of the transformed point
+	  * @param z The z-component of the transformed point
+	  * @param w The homogeneous component of the transformed point
+	  */
+	void transform(const vector3 &vec, double &x, double &y, double &z, double &w) const {
+		x = elements[0][0]*vec.x + elements[0][1]*vec.y + elements[0][2]*vec.z + elements[0][3];
+		y = elements[1][0]*vec.x + elements[1][1]*vec.y + elements[1][2]*vec.z + elements[1][3];
+		z = elements[2][0]*vec.x + elements[2][1]*vec.y + elements[2][2]*vec.z + elements[2][3];
+		w = elements[3][0]*vec.x + elements[3][1]*vec.y + elements[3][2]*vec.z + elements[3][3];
+	}
+
+	/** Dump all matrix elements into a returned string
+	  */
+	std::string dump() const ;
+
+	/** Get the affine matrix which rotates a point and then translates it
+	  * @param rot The rotation to apply
+	  * @param offset The translation to apply after the rotation
+	  */
+	static matrix4 getTransformMatrix(const matrix3 &rot, const vector3 &offset);
+
+	/** Zero all elements of this matrix
+	  */
+	void zero();
+
+	/** Set this matrix to an identity matrix (i.e. diagonal elements are equal to 1 and off-diagonal elements are equal to zero)
+	  */
+	void identity();
+};
+
+#endif
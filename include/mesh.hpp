@@ -0,0 +1,224 @@
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+
+#include "vector3.hpp"
+#include "vertexArray.hpp"
+#include "indexBuffer.hpp"
+
+/** @class meshlet
+  * @brief Cluster of consecutive triangles of a mesh, bounded by a sphere and a cone of normals
+  */
+
+class meshlet{
+public:
+	size_t first; ///< Index of the first triangle in the cluster
+	size_t count; ///< Number of triangles in the cluster
+
+	vector3 center; ///< Center of the sphere which bounds every vertex of the cluster (in object-space)
+	double radius; ///< Radius of the bounding sphere
+
+	vector3 axis; ///< Unit axis of the cone which contains every triangle normal of the cluster
+	double cosAngle; ///< Cosine of the half-angle of the normal cone (zero or less if the cone is too wide to be used)
+	double sinAngle; ///< Sine of the half-angle of the normal cone
+
+	/** Default constructor
+	  */
+	meshlet() : first(0), count(0), center(), radius(0), axis(0, 0, 1), cosAngle(-1), sinAngle(0) { }
+
+	/** Return true if every triangle of the cluster is guaranteed to face away from a point and return false otherwise
+	  * @param point The point to test against (in object-space)
+	  */
+	bool isBackfacing(const vector3 &point) const ;
+};
+
+/** @class mesh
+  * @brief Indexed triangle mesh in object-space
+  *
+  * Each triangle is stored as three entries in an index buffer, which uses 16-bit indices for meshes with
+  * up to 65536 vertices. The unit normal and the center-of-mass of every triangle are kept in two separate
+  * structure-of-arrays, in triangle order, so that per-triangle passes read all of their inputs sequentially.
+  * Consecutive runs of MESHLET_SIZE triangles are grouped into meshlets, which allow whole clusters of
+  * triangles to be rejected before any per-triangle work is done. A chain of simplified versions of the mesh
+  * (levels of detail) may be built once the mesh is complete, for use when the mesh is far from the camera.
+  */
+
+class mesh{
+public:
+	static const size_t MESHLET_SIZE = 64; ///< Number of triangles in each meshlet (a multiple of 32, see vertexArray::computeFacing())
+
+	static const size_t MIN_LOD_TRIANGLES = 128; ///< Smallest number of triangles in a level of detail
+
+	/** Default constructor (empty mesh)
+	  */
+	mesh() : boxMin(), boxMax(), sphereCenter(), sphereRadius(0), sphereChanged(false), meshletsChanged(false), levelsChanged(false) { }
+
+	/** Get the number of unique vertices
+	  */
+	size_t getNumberOfVertices() const { return vertices.size(); }
+
+	/** Get the number of triangles
+	  */
+	size_t getNumberOfTriangles() const { return normals.size(); }
+
+	/** Return true if the mesh contains no triangles and return false otherwise
+	  */
+	bool empty() const { return normals.empty(); }
+
+	/** Get a pointer to the array of all unique vertices
+	  */
+	const vertexArray* getVertices() const { return &vertices; }
+
+	/** Get a pointer to the array of the unit normals of all triangles
+	  */
+	const vertexArray* getNormals() const { return &normals; }
+
+	/** Get a pointer to the array of the center-of-mass of all triangles
+	  */
+	const vertexArray* getCentroids() const { return &centroids; }
+
+	/** Get a pointer to the buffer of vertex indices, three per triangle
+	  */
+	const indexBuffer* getIndices() const { return &indices; }
+
+	/** Get the minimum corner of the axis-aligned box which bounds every vertex
+	  */
+	const vector3& getBoundingBoxMin() const { return boxMin; }
+
+	/** Get the maximum corner of the axis-aligned box which bounds every vertex
+	  */
+	const vector3& getBoundingBoxMax() const { return boxMax; }
+
+	/** Get the center of the sphere which bounds every vertex (the center of the bounding box)
+	  */
+	const vector3& getBoundingSphereCenter() const {
+		if(sphereChanged)
+			updateSphere();
+		return sphereCenter;
+	}
+
+	/** Get the radius of the smallest sphere, centered on the bounding box, which bounds every vertex
+	  * @note The radius is recomputed only if vertices were added since the last call
+	  */
+	double getBoundingSphereRadius() const {
+		if(sphereChanged)
+			updateSphere();
+		return sphereRadius;
+	}
+
+	/** Get the clusters of triangles which make up the mesh
+	  * @note The meshlets are rebuilt only if triangles were added since the last call
+	  */
+	const std::vector<meshlet>& getMeshlets() const {
+		if(meshletsChanged)
+			buildMeshlets();
+		return meshlets;
+	}
+
+	/** Get the number of levels of detail, including the full mesh
+	  * @note Returns one until buildLevelsOfDetail() is called
+	  */
+	size_t getNumberOfLevels() const { return levels.size()+1; }
+
+	/** Get one of the levels of detail, where level 0 is the full mesh and each level has about half as many triangles as the last
+	  */
+	const mesh* getLevel(const size_t &level) const { return (level == 0 ? this : levels[level-1].get()); }
+
+	/** Get an estimate of the largest distance between the surface of one of the levels of detail and that of the full mesh (in object-space)
+	  */
+	double getLevelError(const size_t &level) const { return (level == 0 ? 0 : levelErrors[level-1]); }
+
+	/** Get the indices of the three vertices of a triangle
+	  * @param index The index of the triangle
+	  * @param tri Array of the three vertex indices (must contain at least 3 elements)
+	  */
+	void getTriangle(const size_t &index, unsigned int *tri) const {
+		tri[0] = indices[3*index];
+		tri[1] = indices[3*index+1];
+		tri[2] = indices[3*index+2];
+	}
+
+	/** Compute which triangles face towards a point, using the best available vertex kernel
+	  * @param point The point to test against (in object-space)
+	  * @param mask Bit mask with one bit per triangle, where bit i%32 of word i/32 is set if triangle i faces
+	  *             towards the point (must contain at least (getNumberOfTriangles()+31)/32 elements)
+	  */
+	void computeFacing(const vector3f &point, unsigned int *mask) const { normals.computeFacing(centroids, point, mask); }
+
+	/** Compute which triangles of a meshlet face towards a point, using the best available vertex kernel
+	  * @note Only the words of the mask which hold the triangles of the meshlet are written
+	  */
+	void computeFacing(const meshlet &cluster, const vector3f &point, unsigned int *mask) const { normals.computeFacing(centroids, point, cluster.first, cluster.count, mask); }
+
+	/** Compute the color of each triangle of a meshlet lit by a set of lights, using the best available vertex kernel
+	  * @param cluster The meshlet to shade
+	  * @param lights Array of lights (in object-space)
+	  * @param nLights Number of lights in the array
+	  * @param srgb If set, the colors are sRGB encoded
+	  * @param colors Array of ARGB8888 colors, one per triangle. Elements are written in whole blocks of vertexArray::BLOCK_SIZE,
+	  *               so the array must hold getNumberOfTriangles() rounded up to a multiple of the block size
+	  */
+	void computeShading(const meshlet &cluster, const faceLight *lights, const size_t &nLights, const bool &srgb, unsigned int *colors) const { normals.computeShading(centroids, lights, nLights, cluster.first, cluster.count, srgb, colors); }
+
+	/** Get the total size of the vertex, index, and face arrays (in bytes)
+	  */
+	size_t getMemoryUsage() const ;
+
+	/** Make sure the mesh is able to hold a given number of vertices and triangles without reallocating
+	  */
+	void reserve(const size_t &nVertices, const size_t &nTriangles);
+
+	/** Add a unique vertex to the mesh
+	  * @return The index of the new vertex
+	  */
+	unsigned int addVertex(const vector3f &vertex);
+
+	/** Add a triangle to the mesh and compute its unit normal and center-of-mass
+	  * @note The vertices are assumed to have clockwise orientation, and must already have been added to the mesh
+	  */
+	void addTriangle(const unsigned int &i0, const unsigned int &i1, const unsigned int &i2);
+
+	/** Remove all vertices and triangles from the mesh
+	  */
+	void clear();
+
+	/** Build the chain of levels of detail by repeatedly halving the number of triangles using quadric error simplification
+	  * @note Does nothing if the chain is up to date. The chain is discarded when triangles are added to the mesh
+	  */
+	void buildLevelsOfDetail() const ;
+
+private:
+	vertexArray vertices; ///< Array of all unique vertices
+
+	vector3 boxMin; ///< Minimum corner of the bounding box of all vertices
+	vector3 boxMax; ///< Maximum corner of the bounding box of all vertices
+
+	mutable vector3 sphereCenter; ///< Center of the bounding sphere of all vertices
+	mutable double sphereRadius; ///< Radius of the bounding sphere of all vertices
+	mutable bool sphereChanged; ///< Flag indicating that the bounding sphere is out of date with the vertices
+
+	indexBuffer indices; ///< Indices of the three vertices of each triangle in the array of vertices
+
+	vertexArray normals; ///< Array of the unit normals of all triangles
+	vertexArray centroids; ///< Array of the center-of-mass of all triangles
+
+	mutable std::vector<meshlet> meshlets; ///< Clusters of consecutive triangles (see getMeshlets())
+	mutable bool meshletsChanged; ///< Flag indicating that the meshlets are out of date with the triangles
+
+	mutable std::vector<std::shared_ptr<const mesh> > levels; ///< Simplified versions of the mesh, from finest to coarsest (see buildLevelsOfDetail())
+	mutable std::vector<double> levelErrors; ///< Geometric error of each simplified version of the mesh
+	mutable bool levelsChanged; ///< Flag indicating that the levels of detail are out of date with the triangles
+
+	/** Compute the smallest sphere, centered on the bounding box, which contains every vertex
+	  */
+	void updateSphere() const ;
+
+	/** Split the triangles into meshlets and compute the bounding sphere and normal cone of each of them
+	  */
+	void buildMeshlets() const ;
+};
+
+#endif
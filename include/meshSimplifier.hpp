@@ -0,0 +1,133 @@
+#ifndef MESH_SIMPLIFIER_HPP
+#define MESH_SIMPLIFIER_HPP
+
+#include <vector>
+#include <queue>
+#include <cstddef>
+
+#include "vector3.hpp"
+
+class mesh;
+
+/** @class quadric
+  * @brief Symmetric 4x4 matrix which measures the sum of the squared distances from a point to a set of planes
+  */
+
+class quadric{
+public:
+	/** Default constructor (empty set of planes)
+	  */
+	quadric();
+
+	/** Plane constructor
+	  * @param norm Unit normal of the plane
+	  * @param point Any point on the plane
+	  * @param weight Factor by which the squared distance to the plane is scaled
+	  */
+	quadric(const vector3 &norm, const vector3 &point, const double &weight=1);
+
+	/** Add the planes of another quadric to this one
+	  */
+	quadric& operator += (const quadric &rhs);
+
+	/** Get the sum of the (weighted) squared distances from a point to every plane
+	  */
+	double evaluate(const vector3 &p) const ;
+
+	/** Find the point which minimizes the error
+	  * @param p The point with the smallest error, if one exists
+	  * @return True if a unique minimum exists and return false if the planes are (nearly) parallel
+	  */
+	bool minimize(vector3 &p) const ;
+
+private:
+	double a[10]; ///< Upper triangle of the matrix, row by row
+};
+
+/** @class meshSimplifier
+  * @brief Reduces the number of triangles of a mesh by collapsing edges in order of increasing quadric error
+  *
+  * Follows Garland and Heckbert's quadric error metric. Each vertex accumulates the planes of the triangles around
+  * it, weighted by area, and the edge whose collapse moves the surface the least is removed first. Open boundaries
+  * are held in place by additional planes perpendicular to the boundary triangles. Collapses which would flip a
+  * triangle over are rejected. Simplification may be continued in steps, so a single pass can produce a whole
+  * chain of meshes.
+  */
+
+class meshSimplifier{
+public:
+	/** Mesh constructor
+	  * @param input The mesh to simplify. It is copied, so it may be modified or destroyed afterwards
+	  */
+	meshSimplifier(const mesh &input);
+
+	/** Get the number of triangles remaining
+	  */
+	size_t getNumberOfTriangles() const { return liveTriangles; }
+
+	/** Measure the geometric error of the simplified mesh, which is the largest distance from a vertex of the input
+	  *  to the nearest plane of the triangles around the vertex that it was collapsed into (in object-space)
+	  * @note Unlike the quadric error, this includes the distance between curved input surfaces and the flat
+	  *       triangles which replace them
+	  */
+	double getError() const ;
+
+	/** Collapse edges until no more than a target number of triangles remain
+	  * @return True if the target was reached and return false if no more edges could be collapsed
+	  */
+	bool simplify(const size_t &targetTriangles);
+
+	/** Copy the remaining vertices and triangles into a mesh, keeping the order of the input triangles
+	  */
+	void getMesh(mesh &output) const ;
+
+private:
+	/** Edge which may be collapsed, along with the cost of doing so
+	  */
+	class collapse{
+	public:
+		double cost; ///< Quadric error at the target position
+		unsigned int v0; ///< Vertex which is kept
+		unsigned int v1; ///< Vertex which is removed
+		unsigned int stamp0; ///< Modification count of the kept vertex when the cost was computed
+		unsigned int stamp1; ///< Modification count of the removed vertex when the cost was computed
+		vector3 target; ///< Position of the kept vertex after the collapse
+
+		/** Order collapses so that the cheapest is at the top of the priority queue
+		  */
+		bool operator < (const collapse &rhs) const { return (cost > rhs.cost); }
+	};
+
+	std::vector<vector3> positions; ///< Positions of all vertices
+	std::vector<quadric> quadrics; ///< Error quadric of each vertex
+	std::vector<vector3> inputPositions; ///< Positions of all vertices of the input mesh
+	std::vector<unsigned int> stamps; ///< Number of times each vertex has been modified
+	std::vector<bool> removed; ///< Flags indicating which vertices have been collapsed into another
+	std::vector<unsigned int> parents; ///< Vertex which each removed vertex was collapsed into
+
+	std::vector<unsigned int> triangles; ///< Vertex indices of all triangles, three per triangle
+	std::vector<bool> alive; ///< Flags indicating which triangles have not been collapsed
+	std::vector<std::vector<unsigned int> > vertexTriangles; ///< Triangles which use each vertex
+
+	size_t liveTriangles; ///< Number of triangles remaining
+
+	std::priority_queue<collapse> candidates; ///< Edges which may be collapsed, cheapest first
+
+	/** Compute the cost of collapsing an edge and add it to the queue of candidates
+	  */
+	void addCandidate(const unsigned int &v0, const unsigned int &v1);
+
+	/** Return true if moving a vertex would flip over any of its triangles which do not also use another vertex
+	  * @param vertex The vertex which is moved
+	  * @param other The other vertex of the edge being collapsed
+	  * @param target The new position of the moved vertex
+	  */
+	bool flipsTriangles(const unsigned int &vertex, const unsigned int &other, const vector3 &target) const ;
+
+	/** Collapse an edge, if it is still valid
+	  * @return True if the edge was collapsed and return false otherwise
+	  */
+	bool apply(const collapse &edge);
+};
+
+#endif
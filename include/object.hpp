@@ -1,47 +1,144 @@
 #ifndef OBJECT_HPP
 #define OBJECT_HPP
 
-#include <vector>
+#include <memory>
 
 #include "scene.hpp"
+#include "colors.hpp"
 #include "matrix3.hpp"
-#include "triangle.hpp"
+#include "matrix4.hpp"
+#include "quaternion.hpp"
+#include "mesh.hpp"
+#include "shadingCache.hpp"
+
+class bvh;
+class ray;
 
 class object{
+	friend class bvh;
+
 public:
 	/** Default constructor
 	  */
-	object() : pos(), pos0(), rot(), dmode(scene::WIREFRAME) { }
+	object() : pos(), pos0(), orient(), rot(identityMatrix), rotChanged(false), dmode(scene::WIREFRAME), color(Colors::WHITE), geometry(std::make_shared<mesh>()), sphereCenter(), boxMin(), boxMax(), boundsChanged(true), tree(NULL), treeNode(-1) { }
 
 	/** Object position constructor
 	  */	
-	object(const vector3 &pos_) : pos(pos_), pos0(pos_), rot(), dmode(scene::WIREFRAME) { }
+	object(const vector3 &pos_) : pos(pos_), pos0(pos_), orient(), rot(identityMatrix), rotChanged(false), dmode(scene::WIREFRAME), color(Colors::WHITE), geometry(std::make_shared<mesh>()), sphereCenter(), boxMin(), boxMax(), boundsChanged(true), tree(NULL), treeNode(-1) { }
+
+	/** Shared mesh constructor
+	  * @param geometry_ The mesh to draw, which may be shared with any number of other objects
+	  * @param pos_ The position offset of the object
+	  */
+	object(const std::shared_ptr<mesh> &geometry_, const vector3 &pos_) : pos(pos_), pos0(pos_), orient(), rot(identityMatrix), rotChanged(false), dmode(scene::WIREFRAME), color(Colors::WHITE), geometry(geometry_), sphereCenter(), boxMin(), boxMax(), boundsChanged(true), tree(NULL), treeNode(-1) { }
+
+	/** Copy constructor
+	  * @note The copy shares the mesh of the original, but does not belong to any bounding volume hierarchy and starts with no cached colors
+	  */
+	object(const object &other);
+
+	/** Assignment operator
+	  * @note The object keeps its own place in a bounding volume hierarchy (if any), which is updated for its new bounds
+	  */
+	object& operator = (const object &rhs);
 	
-	/** Get a pointer to the vector of polygons which comprise this 3d object
+	/** Destructor
+	  * @note The object is removed from the bounding volume hierarchy it belongs to, if any
+	  */
+	virtual ~object();
+
+	/** Get a pointer to the indexed triangle mesh which comprises this 3d object (in object-space)
+	  */
+	const mesh* getMesh() const { return geometry.get(); }
+
+	/** Get a shared reference to the mesh which comprises this 3d object, for use by other objects
+	  * @note An object copies its mesh before adding to it if the mesh is shared, so a shared mesh is never modified
+	  */
+	std::shared_ptr<mesh> getSharedMesh() const { return geometry; }
+
+	/** Get a pointer to the array of all unique vertices (in object-space)
 	  */
-	std::vector<triangle>* getPolygons(){ return &polys; }
+	const vertexArray* getVertices() const { return geometry->getVertices(); }
+
+	/** Get a pointer to the array of the unit normals of all polygons (in object-space)
+	  */
+	const vertexArray* getPolygonNormals() const { return geometry->getNormals(); }
+
+	/** Get a pointer to the array of the center-of-mass of all polygons (in object-space)
+	  */
+	const vertexArray* getPolygonCentroids() const { return geometry->getCentroids(); }
 
 	/** Get the position offset of the object
 	  */
 	vector3 getPosition() const { return pos; }
 
+	/** Get the orientation of the object about its position offset
+	  */
+	const quaternion& getOrientation() const { return orient; }
+
+	/** Get the rotation matrix of the object about its position offset
+	  * @note The matrix is recomputed from the orientation only if the orientation has changed since the last call
+	  */
+	const matrix3& getRotation() const {
+		if(rotChanged){
+			orient.getMatrix(rot);
+			rotChanged = false;
+		}
+		return rot;
+	}
+
+	/** Get the model matrix which transforms object-space points into real-space
+	  */
+	matrix4 getModelMatrix() const { return matrix4::getTransformMatrix(getRotation(), pos); }
+
+	/** Get the center of the bounding sphere of the object (in real-space)
+	  */
+	vector3 getBoundingSphereCenter() const { updateBounds(); return pos+sphereCenter; }
+
+	/** Get the radius of the bounding sphere of the object
+	  */
+	double getBoundingSphereRadius() const { return geometry->getBoundingSphereRadius(); }
+
+	/** Get the minimum corner of the axis-aligned bounding box of the object (in real-space)
+	  */
+	vector3 getBoundingBoxMin() const { updateBounds(); return pos+boxMin; }
+
+	/** Get the maximum corner of the axis-aligned bounding box of the object (in real-space)
+	  */
+	vector3 getBoundingBoxMax() const { updateBounds(); return pos+boxMax; }
+
 	/** Get the number of unique vertices
 	  */
-	size_t getNumberOfVertices() const { return vertices.size(); }
+	size_t getNumberOfVertices() const { return geometry->getNumberOfVertices(); }
 	
 	/** Get the number of unique polygons
 	  */
-	size_t getNumberOfPolygons() const { return polys.size(); }
+	size_t getNumberOfPolygons() const { return geometry->getNumberOfTriangles(); }
 
 	/** Get the drawing mode to use when drawing the object to the screen
 	  */
 	scene::drawMode getDrawingMode() const { return dmode; }
 
+	/** Get the base color of the object's surface
+	  */
+	sdlColor getColor() const { return color; }
+
+	/** Check whether or not a ray intersects any of the polygons of the object
+	  * @param r The ray to check for intersection (in real-space)
+	  * @param t The distance along the ray to the closest intersection
+	  * @return True if the ray intersects at least one polygon and return false otherwise
+	  */
+	bool intersects(const ray &r, double &t) const ;
+
 	/** Rotate the object by a given amount about the X, Y, and Z, axes (all in radians)
-	  * @note This method will rotate vertices from their current position. Use setRotation() to specify the rotation explicitly
+	  * @note This method will rotate the object from its current orientation. Use setRotation() to specify the rotation explicitly
 	  */
 	void rotate(const double &theta, const double &phi, const double &psi);
 
+	/** Rotate the object from its current orientation by a rotation quaternion
+	  */
+	void rotate(const quaternion &rotation);
+
 	/** Move the position of the object
 	  * @note This method moves the object relative to its current position. Use setPosition() to specify the position explicitly
 	  */
@@ -51,6 +148,10 @@ public:
 	  */
 	void setRotation(const double &theta, const double &phi, const double &psi);
 
+	/** Set the orientation of the object explicitly
+	  */
+	void setRotation(const quaternion &orientation);
+
 	/** Set the position of the object
 	  */
 	void setPosition(const vector3 &position);
@@ -59,7 +160,18 @@ public:
 	  */
 	void setDrawingMode(const scene::drawMode &mode){ dmode = mode; }
 
-	/** Reset the coordinates of all vertices to their original values
+	/** Set the base color of the object's surface. Filled polygons are drawn in this color, scaled by the lighting in RENDER mode
+	  */
+	void setColor(const sdlColor &color_){
+		color = color_;
+		shading.invalidate();
+	}
+
+	/** Get the cached shaded colors of the object's triangles, which are used in RENDER mode
+	  */
+	shadingCache& getShadingCache(){ return shading; }
+
+	/** Reset the rotation of the object, returning all vertices to their original orientation
 	  */
 	void resetVertices();
 	
@@ -75,18 +187,44 @@ protected:
 	vector3 pos; ///< The position offset of the object (not necessarily the center)
 	vector3 pos0; ///< The original position offset of the object
 	
-	matrix3 rot; ///< The rotation of the object about the offset position
+	quaternion orient; ///< The orientation of the object about the offset position (applied when the object is drawn)
+	
+	mutable matrix3 rot; ///< Rotation matrix equivalent to the orientation (see getRotation())
+	mutable bool rotChanged; ///< Flag indicating that the rotation matrix is out of date with the orientation
 	
 	scene::drawMode dmode; ///< The drawing mode to use when drawing the object to the screen
 	
-	std::vector<vector3> vertices; ///< Vector of all unique vertices
-	std::vector<vector3> vertices0; ///< Vector of all unique vertices with their original coordinates
+	sdlColor color; ///< The base color of the object's surface
 	
-	std::vector<triangle> polys; ///< Vector of all unique polygons which make up this 3d object
+	std::shared_ptr<mesh> geometry; ///< Vertices and polygons which make up this 3d object, in object-space (may be shared with other objects)
+
+	mutable vector3 sphereCenter; ///< Center of the bounding sphere, relative to the position offset
+	mutable vector3 boxMin; ///< Minimum corner of the axis-aligned bounding box, relative to the position offset
+	mutable vector3 boxMax; ///< Maximum corner of the axis-aligned bounding box, relative to the position offset
+	mutable bool boundsChanged; ///< Flag indicating that the bounding volumes are out of date with the mesh or the orientation
+
+	shadingCache shading; ///< Shaded colors of the triangles, kept until the object or the lights change
+
+	bvh *tree; ///< The bounding volume hierarchy which the object belongs to (if any)
+	int treeNode; ///< Index of the object's leaf node in the bounding volume hierarchy
 	
-	/** Rotate all vertices using the object's internal rotation matrix
+	/** Update the object after its orientation changes
+	  * @note Vertices are not modified. The rotation is applied to them when the object is drawn
 	  */
 	void transform();
+
+	/** Rotate the bounding volumes of the mesh to match the object's rotation, if either has changed
+	  * @note Both are stored relative to the position offset, so moving the object does not change them
+	  */
+	void updateBounds() const ;
+
+	/** Notify the bounding volume hierarchy, if any, that the bounding box of the object has changed
+	  */
+	void updateTree();
+	
+	/** Get the mesh for modification, first making a private copy of it if it is shared with other objects
+	  */
+	mesh& getUniqueMesh();
 	
 	/** Add a unique vertex to the vector of vertices
 	  */
@@ -0,0 +1,47 @@
+#ifndef OFFSCREEN_TARGET_HPP
+#define OFFSCREEN_TARGET_HPP
+
+#include <string>
+
+#include "renderTarget.hpp"
+
+/** @class offscreenTarget
+  * @brief In-memory render target with no display or SDL dependency. Finished frames may be
+  *        read back from the framebuffer or written to disk as they are rendered
+  */
+
+class offscreenTarget : public renderTarget {
+public:
+	/** Default constructor
+	  */
+	offscreenTarget() : renderTarget(), frameCount(0), prefix() { }
+
+	/** Constructor taking the width and height of the target (in pixels)
+	  */
+	offscreenTarget(const int &width, const int &height) : renderTarget(width, height), frameCount(0), prefix() { }
+
+	/** Get the number of frames which have been rendered
+	  */
+	unsigned long long getFrameCount() const { return frameCount; }
+
+	/** Write every rendered frame to disk as "<prefix>_<frame>.ppm"
+	  * @note Passing an empty string disables writing frames to disk (the default)
+	  */
+	void setOutputPrefix(const std::string &prefix_){ prefix = prefix_; }
+
+	/** Write the current contents of the framebuffer to a binary PPM image
+	  * @return True if the image was written successfully and return false otherwise
+	  */
+	bool write(const std::string &filename) const { return buffer.write(filename); }
+
+	/** Finish the current frame, writing it to disk if an output prefix was specified
+	  */
+	void render();
+
+private:
+	unsigned long long frameCount; ///< The number of frames which have been rendered
+
+	std::string prefix; ///< Filename prefix for writing frames to disk
+};
+
+#endif
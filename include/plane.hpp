@@ -34,6 +34,11 @@ public:
 	  */
 	bool intersects(const ray &r, double &t) const ;
 
+	/** Get the signed distance from a point to the plane, positive on the side which the normal points toward
+	  * @note The normal vector must have unit length
+	  */
+	double distance(const vector3 &point) const { return (point - p)*norm; }
+
 	/** Dump plane parameters to stdout
 	  */
 	void dump() const ;
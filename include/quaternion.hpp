@@ -0,0 +1,247 @@
+#ifndef QUATERNION_HPP
+#define QUATERNION_HPP
+
+#include <cmath>
+
+#include "vector3.hpp"
+#include "matrix3.hpp"
+
+/** @class quaternionT
+  * @brief Rotation quaternion with a given scalar type
+  *
+  * Orientations are stored as unit quaternions and composed by multiplication, which is much cheaper than
+  * building and multiplying rotation matrices and which is easily re-normalized, so that repeated small
+  * rotations do not accumulate skew. Use getMatrix() to obtain the equivalent rotation matrix when needed.
+  */
+
+template <typename T>
+class quaternionT{
+public:
+	T w; ///< Scalar component
+	T x; ///< X component of the vector part
+	T y; ///< Y component of the vector part
+	T z; ///< Z component of the vector part
+
+	/** Default constructor (identity rotation)
+	  */
+	constexpr quaternionT() : w(1), x(0), y(0), z(0) { }
+
+	/** Explicit component constructor
+	  */
+	constexpr quaternionT(const T &w_, const T &x_, const T &y_, const T &z_) : w(w_), x(x_), y(y_), z(z_) { }
+
+	/** Rotation constructor using theta, phi and psi (all in radians)
+	  * @note Equivalent to the rotation matrix constructed by matrix3T(theta, phi, psi)
+	  */
+	quaternionT(const T &theta, const T &phi, const T &psi){
+		setRotation(theta, phi, psi);
+	}
+
+	/** Rotation matrix constructor
+	  * @note The input matrix must be a proper rotation (orthonormal with a determinant of one)
+	  */
+	explicit quaternionT(const matrix3T<T> &mat){
+		setMatrix(mat);
+	}
+
+	/** Conversion constructor from a quaternion with a different scalar type
+	  */
+	template <typename U>
+	explicit constexpr quaternionT(const quaternionT<U> &other) : w((T)other.w), x((T)other.x), y((T)other.y), z((T)other.z) { }
+
+	/** Compose this rotation with another and return the result
+	  * @note The rotation on the right is applied first
+	  */
+	constexpr quaternionT operator * (const quaternionT &rhs) const {
+		return quaternionT(w*rhs.w - x*rhs.x - y*rhs.y - z*rhs.z,
+		                   w*rhs.x + x*rhs.w + y*rhs.z - z*rhs.y,
+		                   w*rhs.y - x*rhs.z + y*rhs.w + z*rhs.x,
+		                   w*rhs.z + x*rhs.y - y*rhs.x + z*rhs.w);
+	}
+
+	/** Rotate a vector by this quaternion and return the result
+	  * @note This quaternion must have unit length
+	  */
+	vector3T<T> operator * (const vector3T<T> &rhs) const {
+		// v' = v + w*t + u x t, where u is the vector part and t = 2*(u x v)
+		vector3T<T> u(x, y, z);
+		vector3T<T> t = u.cross(rhs)*2;
+		return rhs + t*w + u.cross(t);
+	}
+
+	/** Compose this rotation with another and return the result
+	  */
+	quaternionT& operator *= (const quaternionT &rhs){
+		return ((*this) = (*this)*rhs);
+	}
+
+	/** Equality operator
+	  */
+	constexpr bool operator == (const quaternionT &rhs) const { return (w==rhs.w && x==rhs.x && y==rhs.y && z==rhs.z); }
+
+	/** Inequality operator
+	  */
+	constexpr bool operator != (const quaternionT &rhs) const { return (w!=rhs.w || x!=rhs.x || y!=rhs.y || z!=rhs.z); }
+
+	/** Perform the four dimensional dot product between this quaternion and another and return the result
+	  */
+	constexpr T dot(const quaternionT &rhs) const { return (w*rhs.w + x*rhs.x + y*rhs.y + z*rhs.z); }
+
+	/** Get the conjugate of this quaternion, which is the inverse rotation for a unit quaternion
+	  */
+	constexpr quaternionT conjugate() const { return quaternionT(w, -x, -y, -z); }
+
+	/** Get a normalized version of this quaternion
+	  * @note Does not modify the components of this quaternion
+	  */
+	quaternionT normalize() const {
+		T mag = length();
+		return quaternionT(w/mag, x/mag, y/mag, z/mag);
+	}
+
+	/** Normalize this quaternion and return the result
+	  */
+	quaternionT& normInPlace(){
+		T mag = length();
+		w /= mag;
+		x /= mag;
+		y /= mag;
+		z /= mag;
+		return (*this);
+	}
+
+	/** Compute the length of this quaternion
+	  */
+	T length() const { return std::sqrt(square()); }
+
+	/** Compute the square of the length of this quaternion
+	  */
+	constexpr T square() const { return (w*w + x*x + y*y + z*z); }
+
+	/** Set this to the identity rotation
+	  */
+	void identity(){
+		(*this) = quaternionT();
+	}
+
+	/** Set this to a rotation of a given angle (in radians) about an axis
+	  * @note The axis must have unit length
+	  */
+	void setAxisAngle(const vector3T<T> &axis, const T &angle){
+		T s = std::sin(angle/2);
+		w = std::cos(angle/2);
+		x = axis.x*s;
+		y = axis.y*s;
+		z = axis.z*s;
+	}
+
+	/** Set this to a rotation using theta, phi and psi (all in radians)
+	  * @note Follows the same pitch-roll-yaw convention as matrix3T::setRotation()
+	  */
+	void setRotation(const T &theta, const T &phi, const T &psi){
+		// Half-angle rotations about the y-axis (theta), the z-axis (phi), and the x-axis (psi), applied in that order
+		T c1 = std::cos(theta/2), s1 = std::sin(theta/2);
+		T c2 = std::cos(phi/2), s2 = std::sin(phi/2);
+		T c3 = std::cos(psi/2), s3 = std::sin(psi/2);
+		w = c3*c2*c1 + s3*s2*s1;
+		x = s3*c2*c1 - c3*s2*s1;
+		y = c3*c2*s1 - s3*s2*c1;
+		z = c3*s2*c1 + s3*c2*s1;
+	}
+
+	/** Set this to the rotation described by a rotation matrix
+	  * @note The input matrix must be a proper rotation (orthonormal with a determinant of one)
+	  */
+	void setMatrix(const matrix3T<T> &mat){
+		const T (*m)[3] = mat.elements;
+		T trace = m[0][0] + m[1][1] + m[2][2];
+		if(trace > 0){
+			T s = std::sqrt(trace + 1)*2; // s = 4*w
+			w = s/4;
+			x = (m[2][1] - m[1][2])/s;
+			y = (m[0][2] - m[2][0])/s;
+			z = (m[1][0] - m[0][1])/s;
+		}
+		else if(m[0][0] > m[1][1] && m[0][0] > m[2][2]){
+			T s = std::sqrt(1 + m[0][0] - m[1][1] - m[2][2])*2; // s = 4*x
+			w = (m[2][1] - m[1][2])/s;
+			x = s/4;
+			y = (m[0][1] + m[1][0])/s;
+			z = (m[0][2] + m[2][0])/s;
+		}
+		else if(m[1][1] > m[2][2]){
+			T s = std::sqrt(1 + m[1][1] - m[0][0] - m[2][2])*2; // s = 4*y
+			w = (m[0][2] - m[2][0])/s;
+			x = (m[0][1] + m[1][0])/s;
+			y = s/4;
+			z = (m[1][2] + m[2][1])/s;
+		}
+		else{
+			T s = std::sqrt(1 + m[2][2] - m[0][0] - m[1][1])*2; // s = 4*z
+			w = (m[1][0] - m[0][1])/s;
+			x = (m[0][2] + m[2][0])/s;
+			y = (m[1][2] + m[2][1])/s;
+			z = s/4;
+		}
+	}
+
+	/** Compute the rotation matrix which is equivalent to this quaternion
+	  * @note This quaternion must have unit length
+	  */
+	void getMatrix(matrix3T<T> &mat) const {
+		T xx = x*x, yy = y*y, zz = z*z;
+		T xy = x*y, xz = x*z, yz = y*z;
+		T wx = w*x, wy = w*y, wz = w*z;
+		mat.elements[0][0] = 1 - 2*(yy + zz); mat.elements[0][1] = 2*(xy - wz);     mat.elements[0][2] = 2*(xz + wy);
+		mat.elements[1][0] = 2*(xy + wz);     mat.elements[1][1] = 1 - 2*(xx + zz); mat.elements[1][2] = 2*(yz - wx);
+		mat.elements[2][0] = 2*(xz - wy);     mat.elements[2][1] = 2*(yz + wx);     mat.elements[2][2] = 1 - 2*(xx + yy);
+	}
+
+	/** Compute the rotation matrix which is equivalent to this quaternion
+	  * @note This quaternion must have unit length
+	  */
+	matrix3T<T> getMatrix() const {
+		matrix3T<T> mat;
+		getMatrix(mat);
+		return mat;
+	}
+
+	/** Spherical linear interpolation between two unit quaternions along the shortest arc
+	  * @param q0 The rotation at t = 0
+	  * @param q1 The rotation at t = 1
+	  * @param t The interpolation parameter, in the range [0, 1]
+	  * @return The interpolated rotation, with unit length
+	  */
+	static quaternionT slerp(const quaternionT &q0, const quaternionT &q1, const T &t){
+		// The quaternions q and -q describe the same rotation. Flip q1 if needed so that the shorter arc is followed
+		T cosOmega = q0.dot(q1);
+		T sign = 1;
+		if(cosOmega < 0){
+			cosOmega = -cosOmega;
+			sign = -1;
+		}
+		T a, b;
+		if(cosOmega > (T)0.9995){ // Nearly parallel, fall back to linear interpolation to avoid dividing by sin(omega) ~ 0
+			a = 1 - t;
+			b = t;
+		}
+		else{
+			T omega = std::acos(cosOmega);
+			T invSin = 1/std::sin(omega);
+			a = std::sin((1 - t)*omega)*invSin;
+			b = std::sin(t*omega)*invSin;
+		}
+		b *= sign;
+		quaternionT retval(q0.w*a + q1.w*b, q0.x*a + q1.x*b, q0.y*a + q1.y*b, q0.z*a + q1.z*b);
+		return retval.normInPlace();
+	}
+
+	/** Dump quaternion components to stdout
+	  */
+	void dump() const ;
+};
+
+typedef quaternionT<double> quaternion; ///< Double precision quaternion used for scene-level math
+typedef quaternionT<float> quaternionf; ///< Single precision quaternion
+
+#endif
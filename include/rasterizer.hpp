@@ -0,0 +1,158 @@
+#ifndef RASTERIZER_HPP
+#define RASTERIZER_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "scene.hpp"
+#include "threadPool.hpp"
+#include "halfSpace.hpp"
+
+class frameBuffer;
+class depthBuffer;
+
+const int DEFAULT_TILE_SIZE = 64;
+
+/** @class rasterizer
+  * @brief Tile-binned, multithreaded filled triangle rasterizer
+  *
+  * Triangles submitted with addTriangle() are binned into square screen tiles according to their
+  * bounding boxes. When flush() is called, the tiles are rasterized in parallel by a pool of threads.
+  * Each tile is only ever touched by a single thread and triangles within a tile are drawn in
+  * submission order, so no locking is required on the color or depth buffers and the result
+  * is identical to drawing every triangle serially.
+  *
+  * Vertices are given in fixed-point (28.4) sub-pixel coordinates and a pixel is drawn when its center
+  * lies inside of the triangle. Pixel centers which lie exactly on an edge are drawn only for top and
+  * left edges, so pixels along an edge shared by two triangles are drawn exactly once.
+  *
+  * Two fill methods are available. The scanline method walks the triangle edges one row at a time,
+  * while the half-space method evaluates the three edge functions over square blocks of pixels,
+  * rejecting or accepting whole blocks at once and testing the remaining pixels with SSE2 or AVX2.
+  * The instruction set used by the half-space method is selected at runtime from what the CPU supports.
+  */
+
+class rasterizer{
+public:
+	/** Supported triangle fill methods
+	  */
+	enum fillMethod {SCANLINE, ///< Fill triangles one horizontal span at a time
+	                 HALFSPACE ///< Fill triangles by evaluating edge functions over blocks of pixels
+	};
+
+	/** Instruction sets which may be used by the half-space fill method
+	  */
+	enum simdLevel {SIMD_NONE, ///< Scalar code on 8x8 pixel blocks
+	                SIMD_SSE2, ///< SSE2 on 4x4 pixel blocks
+	                SIMD_AVX2  ///< AVX2 on 8x8 pixel blocks
+	};
+
+	/** Default constructor
+	  */
+	rasterizer();
+
+	/** Get the width and height of the square screen tiles (in pixels)
+	  */
+	int getTileSize() const { return tileSize; }
+
+	/** Get the method used to fill triangles
+	  */
+	fillMethod getFillMethod() const { return method; }
+
+	/** Get the instruction set used by the half-space fill method
+	  */
+	simdLevel getSimdLevel() const { return simd; }
+
+	/** Get the total number of threads used for rasterization
+	  */
+	size_t getNumberOfThreads() const { return pool.getNumberOfThreads(); }
+
+	/** Get the number of triangles submitted since the last call to flush()
+	  */
+	size_t getNumberOfTriangles() const { return triangles.size(); }
+
+	/** Set the color and depth buffers to draw into
+	  * @note The two buffers must have the same dimensions
+	  */
+	void setBuffers(frameBuffer *color_, depthBuffer *depth_);
+
+	/** Set the region of the buffers which may be drawn into. Pixels with (minX <= x < maxX) and (minY <= y < maxY) will be drawn
+	  */
+	void setClipRegion(const int &minX, const int &minY, const int &maxX, const int &maxY);
+
+	/** Set the method used to fill triangles
+	  */
+	void setFillMethod(const fillMethod &method_){ method = method_; }
+
+	/** Set the instruction set used by the half-space fill method
+	  * @note If the CPU (or the build) does not support the requested level, the best supported level is used instead
+	  */
+	void setSimdLevel(const simdLevel &level);
+
+	/** Set the width and height of the square screen tiles (in pixels)
+	  * @note The size is rounded up to a multiple of 8 pixels so that half-space blocks never straddle two tiles
+	  * @note Any triangles which have not been flushed are discarded
+	  */
+	void setTileSize(const int &size);
+
+	/** Set the total number of threads used for rasterization (zero for one per hardware thread)
+	  */
+	void setNumberOfThreads(const size_t &nThreads){ pool.setNumberOfThreads(nThreads); }
+
+	/** Add a filled triangle to the list of triangles to draw
+	  * @param coords The pixel coordinate holder for the three vertex projections
+	  * @param color The packed ARGB8888 fill color of the triangle
+	  */
+	void addTriangle(const scene::pixelTriplet &coords, const unsigned int &color);
+
+	/** Rasterize all submitted triangles into the color and depth buffers and clear the list of triangles
+	  */
+	void flush();
+
+	/** Get the best instruction set supported by both the CPU and the build
+	  */
+	static simdLevel getSupportedSimdLevel();
+
+private:
+	frameBuffer *colorBuffer; ///< The color buffer to draw into
+	depthBuffer *depthBuf; ///< The depth buffer to draw into
+
+	int clipMinX; ///< Minimum horizontal pixel which may be drawn
+	int clipMinY; ///< Minimum vertical pixel which may be drawn
+	int clipMaxX; ///< One past the maximum horizontal pixel which may be drawn
+	int clipMaxY; ///< One past the maximum vertical pixel which may be drawn
+
+	fillMethod method; ///< The method used to fill triangles
+
+	simdLevel simd; ///< The instruction set used by the half-space fill method
+
+	halfSpaceKernel kernel; ///< The half-space kernel for the selected instruction set
+
+	int tileSize; ///< Width and height of the square screen tiles (in pixels)
+	int nTilesX; ///< Number of tiles across the width of the buffers
+	int nTilesY; ///< Number of tiles across the height of the buffers
+
+	std::vector<halfSpaceTriangle> triangles; ///< Setup for all triangles submitted since the last flush
+
+	std::vector<std::vector<unsigned int> > bins; ///< Indices of the triangles which overlap each tile, in submission order
+
+	std::vector<size_t> activeTiles; ///< Indices of all tiles with at least one triangle
+
+	threadPool pool; ///< Threads used to rasterize tiles in parallel
+
+	/** Compute the number of tiles and reallocate the bins
+	  */
+	void updateTiles();
+
+	/** Draw all triangles binned into a single tile
+	  */
+	void rasterizeTile(const size_t &index);
+
+	/** Scanline fill a triangle, testing each pixel against the depth buffer
+	  * @param tri The triangle to draw
+	  * @param target The buffers and the region of them which may be drawn into
+	  */
+	void fillTriangle(const halfSpaceTriangle &tri, const halfSpaceTarget &target);
+};
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef RENDER_TARGET_HPP
+#define RENDER_TARGET_HPP
+
+#include <cstddef>
+
+#include "colors.hpp"
+#include "frameBuffer.hpp"
+
+class SDL_KeyboardEvent;
+class SDL_MouseButtonEvent;
+class SDL_MouseMotionEvent;
+
+const int DEFAULT_WINDOW_WIDTH = 640;
+const int DEFAULT_WINDOW_HEIGHT = 480;
+
+class sdlKeyEvent{
+public:
+	unsigned char key;
+
+	bool down;
+	bool none;
+	bool lshift;
+	bool rshift;
+	bool lctrl;
+	bool rctrl;
+	bool lalt;
+	bool ralt;
+	bool lgui;
+	bool rgui;
+	bool num;
+	bool caps;
+	bool mode;
+
+	sdlKeyEvent() : key(0x0),
+	                down(false), none(true),
+	                lshift(false), rshift(false),
+	                lctrl(false), rctrl(false),
+	                lalt(false), ralt(false),
+	                lgui(false), rgui(false),
+	                num(false), caps(false), mode(false) { }
+
+	void decode(const SDL_KeyboardEvent* evt, const bool &isDown);
+};
+
+class sdlMouseEvent{
+public:
+	unsigned char clicks;
+
+	int x;
+	int y;
+	int xrel;
+	int yrel;
+
+	bool down;
+	bool lclick;
+	bool mclick;
+	bool rclick;
+	bool x1;
+	bool x2;
+
+	sdlMouseEvent() : clicks(0x0),
+	                  x(0), y(0), xrel(0), yrel(0),
+	                  down(false), lclick(false), mclick(false), rclick(false),
+	                  x1(false), x2(false) { }
+
+	void decode(const SDL_MouseButtonEvent* evt, const bool &isDown);
+
+	void decode(const SDL_MouseMotionEvent* evt);
+};
+
+/** @class renderTarget
+  * @brief Abstract destination for rendered frames. All drawing is done into a CPU-side framebuffer
+  *        and derived classes decide what happens to the finished frame in render()
+  */
+
+class renderTarget{
+public:
+	/** Default constructor
+	  */
+	renderTarget() : W(DEFAULT_WINDOW_WIDTH), H(DEFAULT_WINDOW_HEIGHT), init(false) { }
+
+	/** Constructor taking the width and height of the target (in pixels)
+	  */
+	renderTarget(const int &width, const int &height) : W(width), H(height), init(false) { }
+
+	/** Destructor
+	  */
+	virtual ~renderTarget(){ }
+
+	/** Get the width of the target (in pixels)
+	  */
+	int getWidth() const { return W; }
+
+	/** Get the height of the target (in pixels)
+	  */
+	int getHeight() const { return H; }
+
+	/** Get a pointer to the last user keypress event
+	  */
+	sdlKeyEvent* getKeypress(){ return &lastKey; }
+
+	/** Get a pointer to the last user mouse event
+	  */
+	sdlMouseEvent* getMouse(){ return &lastMouse; }
+
+	/** Get a pointer to the CPU-side framebuffer which all drawing routines write into
+	  */
+	frameBuffer* getBuffer(){ return &buffer; }
+
+	/** Set the width of the target (in pixels)
+	  * @note Has no effect after the target has been initialized
+	  */
+	void setWidth(const int &width){ W = width; }
+
+	/** Set the height of the target (in pixels)
+	  * @note Has no effect after the target has been initialized
+	  */
+	void setHeight(const int &height){ H = height; }
+
+	/** Set the current draw color
+	  */
+	void setDrawColor(const sdlColor &color, const float &alpha=1){ buffer.setDrawColor(color, alpha); }
+
+	/** Clear the screen with a given color
+	  */
+	void clear(const sdlColor &color=Colors::BLACK){ buffer.clear(color); }
+
+	/** Draw a single pixel at position (x, y)
+	  */
+	void drawPixel(const int &x, const int &y){ buffer.drawPixel(x, y); }
+
+	/** Draw multiple pixels at positions (x1, y1) (x2, y2) ... (xN, yN)
+	  * @param x Array of X pixel coordinates
+	  * @param y Array of Y pixel coordinates
+	  * @param N The number of elements in the arrays and the number of pixels to draw
+	  */
+	void drawPixel(const int *x, const int *y, const size_t &N);
+
+	/** Draw a single line to the screen between points (x1, y1) and (x2, y2)
+	  */
+	void drawLine(const int &x1, const int &y1, const int &x2, const int &y2){ buffer.drawLine(x1, y1, x2, y2); }
+
+	/** Draw multiple lines to the screen
+	  * @param x Array of X pixel coordinates
+	  * @param y Array of Y pixel coordinates
+	  * @param N The number of elements in the arrays. Since it is assumed that the number of elements
+	           in the arrays is equal to @a N, the total number of lines which will be drawn is equal to N-1
+	  */
+	void drawLine(const int *x, const int *y, const size_t &N);
+
+	/** Render the current frame
+	  */
+	virtual void render() = 0;
+
+	/** Return true if the target is still open and return false otherwise
+	  */
+	virtual bool status(){ return true; }
+
+	/** Allocate the framebuffer
+	  */
+	virtual void initialize();
+
+protected:
+	int W; ///< Width of the target (in pixels)
+	int H; ///< Height of the target (in pixels)
+
+	bool init; ///< Flag indicating that the target has been initialized
+
+	frameBuffer buffer; ///< CPU-side framebuffer which all drawing routines write into
+
+	sdlKeyEvent lastKey; ///< The last key which was pressed by the user
+	sdlMouseEvent lastMouse; ///< The last mouse event which was performed by the user
+};
+
+#endif
@@ -2,19 +2,27 @@
 #define SCENE_HPP
 
 #include <vector>
+#include <unordered_map>
 #include <cstddef>
 #include <chrono>
 
 #include "lightSource.hpp"
+#include "depthBuffer.hpp"
+#include "bvh.hpp"
+#include "shadowMap.hpp"
 
-class sdlWindow;
+class renderTarget;
 class sdlKeyEvent;
 class sdlMouseEvent;
 
 class object;
+class mesh;
 class camera;
+class rasterizer;
 class lightSource;
-class triangle;
+
+const int SUBPIXEL_BITS = 4; ///< Number of fractional bits in fixed-point (28.4) pixel coordinates
+const int SUBPIXEL_SCALE = 1 << SUBPIXEL_BITS; ///< Number of sub-pixel steps per pixel
 
 // Make a typedef for clarity when working with chrono.
 typedef std::chrono::system_clock sclock;
@@ -42,39 +50,75 @@ public:
 	  */
 	class pixelTriplet{
 	public:
-		triangle *tri; ///< Pointer to the real triangle
+		int pX[3]; ///< The horizontal fixed-point (28.4) pixel coordinates for the three vertices
+		int pY[3]; ///< The vertical fixed-point (28.4) pixel coordinates for the three vertices
 
-		int pX[3]; ///< The horizontal pixel coordinates for the three vertices
-		int pY[3]; ///< The vertical pixel coordinates for the three vertices
+		float pZ[3]; ///< The normalized reciprocal depths for the three vertices (see depthBuffer)
 
 		bool draw[3]; ///< Flag for each vertex indicating that it is on the screen
 
 		/** Default constructor
 		  */
 		pixelTriplet() { }
-		
-		/** Constructor taking a pointer to a 3d triangle
-		  */
-		pixelTriplet(triangle *t) : tri(t) { }
 
 		/** Return true if at least one of the vertices is on the screen and return false otherwise
 		  */
 		bool goodToDraw() const { return (draw[0] || draw[1] || draw[2]); }
 	};
 
+	/** @class projectedVertex
+	  * @brief Projection of a single object vertex, computed once per frame and shared by every triangle which uses it
+	  */
+	class projectedVertex{
+	public:
+		double cX; ///< The x-component of the vertex in homogeneous clip-space
+		double cY; ///< The y-component of the vertex in homogeneous clip-space
+		double cZ; ///< The z-component of the vertex in homogeneous clip-space
+		double cW; ///< The homogeneous w-component of the vertex in clip-space
+
+		int pX; ///< The horizontal fixed-point (28.4) pixel coordinate (only set if the vertex is in front of the near plane)
+		int pY; ///< The vertical fixed-point (28.4) pixel coordinate (only set if the vertex is in front of the near plane)
+
+		float pZ; ///< The normalized reciprocal depth (see depthBuffer)
+
+		unsigned short outcode; ///< Bit mask of the clipping planes which the vertex lies outside of
+	};
+
+	/** @class edgeTriplet
+	  * @brief Pixel coordinates of a triangle whose edges will be drawn on top of all filled triangles
+	  */
+	class edgeTriplet{
+	public:
+		pixelTriplet coords; ///< The pixel coordinates of the triangle
+
+		bool depthTest; ///< Flag indicating that the edges should be hidden behind filled triangles
+
+		unsigned char edges; ///< Bit mask of the edges to draw, where bit i is the edge from vertex i to vertex i+1
+
+		/** Constructor taking the pixel coordinates, the depth test flag, and the mask of edges to draw
+		  */
+		edgeTriplet(const pixelTriplet &coords_, const bool &depthTest_, const unsigned char &edges_=0x7) : coords(coords_), depthTest(depthTest_), edges(edges_) { }
+	};
+
 	/** Default constructor
 	  */
 	scene();
 	
 	/** Constructor taking a pointer to a camera
+	  * @note The scene will render into an offscreen (in-memory) target
 	  */
 	scene(camera *cam_);
 
+	/** Constructor taking a pointer to a camera and a pointer to the target to render into
+	  * @note The scene does not take ownership of the render target
+	  */
+	scene(camera *cam_, renderTarget *target_);
+
 	/** Destructor
 	  */
 	~scene();
 
-	/** Opening the SDL window
+	/** Initialize the render target, creating an offscreen target if one was not specified
 	  */
 	void initialize();
 
@@ -90,6 +134,10 @@ public:
 	  */	
 	int getScreenHeight() const { return screenHeightPixels; }
 	
+	/** Get a pointer to the target which the scene is rendered into
+	  */
+	renderTarget *getRenderTarget(){ return window; }
+
 	/** Get a pointer to the main camera
 	  */
 	camera *getCamera(){ return cam; }
@@ -98,6 +146,18 @@ public:
 	  */
 	lightSource *getWorldLight(){ return &worldLight; }
 
+	/** Get a pointer to the tile rasterizer used to draw filled triangles
+	  */
+	rasterizer *getRasterizer(){ return raster; }
+
+	/** Get a pointer to the depth buffer
+	  */
+	depthBuffer *getDepthBuffer(){ return &depth; }
+
+	/** Get a pointer to the bounding volume hierarchy over all objects in the scene
+	  */
+	bvh *getObjectTree(){ return &objectTree; }
+
 	/** Get the total time elapsed since the scene was initialized (in seconds)
 	  */
 	double getTimeElapsed() const { return timeElapsed; }
@@ -138,6 +198,10 @@ public:
 	  */
 	void setCamera(camera *cam_);
 
+	/** Set the storage format of the depth buffer
+	  */
+	void setDepthFormat(const depthBuffer::depthFormat &fmt){ depth.setFormat(fmt); }
+
 	/** Enable or disable the drawing of triangle normals
 	  */
 	void setDrawNormals(const bool &enable=true){ drawNorm = enable; }
@@ -146,24 +210,72 @@ public:
 	  */
 	void setDrawOrigin(const bool &enable=true){ drawOrigin = enable; }
 
+	/** Set the width and height of the shadow maps of all lights which cast shadows (in pixels)
+	  * @note Maps are redrawn at the new size on the next frame
+	  */
+	void setShadowMapSize(const int &size){ shadowMapSize = size; }
+
+	/** Set the distance by which a triangle must lie behind a shadow map to be shadowed (in m)
+	  * @note Takes effect on the next frame, without redrawing the maps
+	  */
+	void setShadowBias(const double &bias){
+		shadowBias = bias;
+		lightingRevision++;
+	}
+
+	/** Enable or disable sRGB output. When enabled, RENDER mode shading is done in linear light, with object colors
+	  * decoded from sRGB, and the shaded colors are sRGB encoded when they are written to the framebuffer
+	  * @note Light colors, and the flat colors of the other drawing modes, are used as they are
+	  */
+	void setSrgbOutput(const bool &enable=true){
+		srgbOutput = enable;
+		lightingRevision++;
+	}
+
 	/** Set the target maximum framerate for rendering (in Hz)
 	  */
 	void setFramerateCap(const double &cap){ framerateCap = cap; }
 
+	/** Get the level of detail bias
+	  */
+	double getLevelOfDetailBias() const { return lodBias; }
+
+	/** Set the level of detail bias, which may be changed at any time
+	  * @param bias Each unit of positive bias doubles the on-screen error allowed when picking a simplified version
+	  *             of a mesh, so coarser meshes are drawn. Each unit of negative bias halves it
+	  */
+	void setLevelOfDetailBias(const double &bias){ lodBias = bias; }
+
 	/** Add an object to the list of objects to be rendered
 	  */
-	void addObject(object *obj){ objects.push_back(obj); }
+	void addObject(object *obj);
+
+	/** Find the closest object which is under a pixel on the screen
+	  * @param px The horizontal pixel coordinate
+	  * @param py The vertical pixel coordinate
+	  * @param t The distance from the camera to the closest intersection
+	  * @return Pointer to the closest object, or NULL if no object is under the pixel
+	  */
+	object* pickObject(const int &px, const int &py, double &t);
+
+	/** Find the closest object which is intersected by a ray
+	  * @param r The ray to cast
+	  * @param t The distance along the ray to the closest intersection
+	  * @return Pointer to the closest object, or NULL if no object is intersected
+	  */
+	object* pickObject(const ray &r, double &t){ return objectTree.raycast(r, t); }
 	
-	/** Add a light to the list of lights to be rendered
+	/** Add a light to the list of lights which shade objects in RENDER mode, in addition to the world light
+	  * @note The light is not copied, so it may be changed after it is added. It must outlive the scene
 	  */
-	void addLight(const lightSource &light){ lights.push_back(light); }
+	void addLight(lightSource *light){ lights.push_back(light); }
 
 	/** Render a 3d object
 	  * @param obj Pointer to the object to draw
 	  */
 	void render(object* obj);
 
-	/** Clear the screen by filling it with a color (black by default)
+	/** Clear the screen by filling it with a color (black by default) and reset the depth buffer
 	  */
 	void clear(const sdlColor &color=Colors::BLACK);
 	
@@ -186,12 +298,21 @@ private:
 
 	unsigned short framerateCap; ///< The target render framerate (in Hz)
 	
+	double lodBias; ///< Base-2 logarithm of the factor by which the on-screen error allowed for levels of detail is scaled
+	
 	unsigned long long updateCount; ///< The number of times the user has called update()
 
 	bool drawNorm; ///< Flag indicating that normal vectors will be drawn on each triangle
 	bool drawOrigin; ///< Flag indicating that the X, Y, and Z axes will be drawn at the origin
+	bool srgbOutput; ///< Flag indicating that shaded colors will be sRGB encoded
 	bool isRunning; ///< Flag indicating that the window is still open and active
 
+	unsigned long long lightingRevision; ///< Incremented whenever a light changes, which invalidates the shading cache of every object
+
+	int shadowMapSize; ///< Width and height of every shadow map (in pixels)
+
+	double shadowBias; ///< Distance by which a face must lie behind a shadow map to be shadowed (in m)
+
 	int screenWidthPixels; ///< Width of the viewing window (in pixels)
 	int screenHeightPixels; ///< Height of the viewing window (in pixels)
 
@@ -206,19 +327,109 @@ private:
 
 	camera *cam;
 	
-	sdlWindow *window; ///< Pointer to the main renderer window
+	renderTarget *window; ///< Pointer to the main render target
+
+	bool ownsWindow; ///< Flag indicating that the render target was created by (and will be deleted by) the scene
 	
 	directionalLight worldLight; ///< Global light source
+
+	depthBuffer depth; ///< Per-pixel depth buffer used by the SOLID and RENDER drawing modes
 	
 	std::vector<object*> objects;
+
+	bvh objectTree; ///< Bounding volume hierarchy over all objects, used for culling and picking
+
+	std::vector<object*> visibleObjects; ///< Objects found to be inside the viewing frustum during the current update
+
+	std::unordered_map<const mesh*, size_t> batchIndex; ///< Index of the batch of visible objects which draw each mesh, during the current update
+
+	std::vector<std::vector<object*> > meshBatches; ///< Visible objects grouped by the mesh which they draw, in order of first appearance
+
+	std::vector<const mesh*> batchMeshes; ///< The mesh drawn by each batch of visible objects
 	
-	std::vector<lightSource> lights;
+	std::vector<lightSource*> lights; ///< Lights which shade objects in RENDER mode, in addition to the world light
+
+	std::vector<faceLight> shadingLights; ///< World light and the lights which reach the object currently being processed (in object-space)
+
+	std::vector<unsigned int> lightRevisions; ///< Revision of the world light and of each light as of the last frame
+
+	std::vector<shadowMap> shadowMaps; ///< Shadow map of the world light and of each light (only drawn for lights which cast shadows)
+
+	std::vector<object*> shadowCasters; ///< Objects which are drawn into the shadow map currently being drawn
+
+	std::vector<const shadowMap*> shadingMaps; ///< Shadow map of each light in the list of shading lights which casts shadows, in order
+
+	std::vector<unsigned long long> shadowRevisions; ///< Revision of each shadow map which reaches the object currently being processed (zero for maps which do not)
+
+	std::vector<float> shadowVisibility; ///< Fraction of each shadowed light which reaches each triangle of the object currently being processed
+
+	rasterizer *raster; ///< Tile-binned multithreaded rasterizer used to draw all filled triangles
+
+	std::vector<projectedVertex> projectedVertices; ///< Projections of all vertices of the object currently being processed
+
+	std::vector<unsigned int> faceMask; ///< Bit mask of the triangles of the object currently being processed which survived culling
+
+	std::vector<edgeTriplet> edgesToDraw; ///< Triangles whose edges will be drawn after all filled triangles
+
+	std::vector<ray> normalsToDraw; ///< Surface normals which will be drawn after all filled triangles
+
+	/** Increment the lighting revision if any light has changed through its setters since the last frame, or if lights were added.
+	  *  Shadow maps are redrawn if their light has changed or if an object has been added, removed, or moved within view of the map
+	  */
+	void updateLighting();
+
+	/** Fill the list of shading lights with the world light and the lights which reach an object, in the object's reference frame
+	  * @param obj The object being shaded
+	  * @param geometry The mesh (or level of detail) of the object which is being drawn, whose triangles may be shadowed
+	  */
+	void setShadingLights(const object *obj, const mesh *geometry);
 
-	std::vector<pixelTriplet> polygonsToDraw;
+	/** Fill the list of shadow revisions with the revision of the shadow map of each light which is able to reach an object
+	  * @note The shaded colors of the object are kept for as long as this list does not change
+	  */
+	void setShadowRevisions(const object *obj);
+
+	/** Project all vertices of a mesh onto the screen using an object's transform, storing the results in the projected vertex cache
+	  */
+	void projectVertices(const object *obj, const mesh *geometry);
+
+	/** Pick the level of detail of an object's mesh from the projected size of its bounding sphere
+	  * @param obj The object to draw
+	  * @param maxPixelError The largest on-screen geometric error allowed (in pixels)
+	  * @return The coarsest level of detail whose projected error is small enough
+	  */
+	const mesh* selectLevel(const object *obj, const double &maxPixelError) const ;
+
+	/** Draw every instance of a mesh
+	  * @param geometry The mesh to draw, which may be one of the levels of detail of the objects' mesh
+	  * @param instances Visible objects which all draw the same mesh
+	  */
+	void processMesh(const mesh *geometry, const std::vector<object*> &instances);
+
+	/** Project, cull, shade, and submit every triangle of each instance of a mesh
+	  * @note The mesh arrays and meshlets are looked up once and reused for all of the instances
+	  * @param geometry The mesh to draw
+	  * @param instances Visible objects which all draw the same mesh
+	  * @param indices The mesh's index buffer, three indices per triangle
+	  */
+	template <typename IndexT>
+	void processInstances(const mesh *geometry, const std::vector<object*> &instances, const IndexT *indices);
 
-	/** 
+	/** Clip a triangle against the near plane, and the guard band if needed, and submit the visible part of it
+	  * @param verts The projected vertices of the triangle
+	  * @param clipMask Bit mask of the clipping planes which at least one of the vertices lies outside of
+	  * @param mode The drawing mode of the object
+	  * @param color The packed ARGB8888 fill color of the triangle
 	  */
-	void processObject(object *obj);
+	void clipTriangle(const projectedVertex* const *verts, const unsigned short &clipMask, const drawMode &mode, const unsigned int &color);
+
+	/** Add a triangle to the rasterizer and/or the list of edges to draw, according to a drawing mode
+	  * @param pixels The pixel coordinates of the triangle
+	  * @param mode The drawing mode of the object
+	  * @param color The packed ARGB8888 fill color of the triangle
+	  * @param edges Bit mask of the edges of the triangle to outline (see edgeTriplet)
+	  */
+	void submitTriangle(const pixelTriplet &pixels, const drawMode &mode, const unsigned int &color, const unsigned char &edges=0x7);
 
 	/**
 	  */
@@ -235,16 +446,6 @@ private:
 	  */
 	bool convertToPixelSpace(const double &x, const double &y, int &px, int &py);
 
-	/** Convert screen-space coordinates [-1, 1] to pixel-space
-	  * @note The origin of pixel-space is the upper-left corner of the screen with the positive x-direction
-	  *       being toward the right side of the screen and the positive y-direction being toward the bottom
-	  * @param x Array of horizontal components of the screen-space coordinates (must contain at least 3 elements)
-	  * @param y Array of vertical components of the screen-space coordinates (must contain at least 3 elements)
-	  * @param coords The pixel coordinate holder for the three vertex projections
-	  * @return True if at least one of the vertices is on the screen and return false otherwise
-	  */
-	bool convertToPixelSpace(const double *x, const double *y, pixelTriplet &coords);
-
 	/** Draw a point to the screen
 	  * @param point The point in 3d space to draw
 	  * @param color The color of the point
@@ -266,19 +467,24 @@ private:
 	  */
 	void drawRay(const ray &proj, const sdlColor &color, const double &length=1);
 	
+	/** Draw a line to the screen which is tested (but not written) against the depth buffer
+	  * @param x0 The horizontal pixel coordinate of the start of the line
+	  * @param y0 The vertical pixel coordinate of the start of the line
+	  * @param q0 The normalized reciprocal depth of the start of the line
+	  * @param x1 The horizontal pixel coordinate of the end of the line
+	  * @param y1 The vertical pixel coordinate of the end of the line
+	  * @param q1 The normalized reciprocal depth of the end of the line
+	  */
+	void drawDepthLine(int x0, int y0, float q0, int x1, int y1, float q1);
+
 	/** Draw the outline of a triangle to the screen
 	  * @param coords The pixel coordinate holder for the three vertex projections
 	  * @param color The line color of the triangle
+	  * @param depthTest If set, only draw the parts of the outline which are not hidden by filled triangles
+	  * @param edges Bit mask of the edges to draw, where bit i is the edge from vertex i to vertex i+1
 	  * @note There must be AT LEAST three elements in each array
 	  */
-	void drawTriangle(const pixelTriplet &coords, const sdlColor &color);
-	
-	/** Draw a filled triangle to the screen
-	  * @param coords The pixel coordinate holder for the three vertex projections
-	  * @param color The fill color of the triangle
-	  * @note There must be AT LEAST three elements in each array
-	  */
-	void drawFilledTriangle(const pixelTriplet &coords, const sdlColor &color);
+	void drawTriangle(const pixelTriplet &coords, const sdlColor &color, const bool &depthTest=false, const unsigned char &edges=0x7);
 };
 
 #endif
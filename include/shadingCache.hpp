@@ -0,0 +1,73 @@
+#ifndef SHADING_CACHE_HPP
+#define SHADING_CACHE_HPP
+
+#include <vector>
+
+#include "mesh.hpp"
+
+/** @class shadingCache
+  * @brief Shaded color of each triangle of an object, kept between frames for as long as the object and the lights do not change
+  *
+  * Colors are computed one meshlet at a time, the first time a meshlet survives culling, so meshlets which are never
+  * seen are never shaded. All colors are discarded when the object is moved, rotated, or recolored, when a different
+  * mesh (or level of detail) is drawn, when the scene's lighting revision changes, or when a shadow map which reaches
+  * the object is redrawn.
+  */
+
+class shadingCache{
+public:
+	/** Default constructor (empty cache)
+	  */
+	shadingCache() : geometry(NULL), lighting(0) { }
+
+	/** Prepare the cache to hold the colors of a mesh under a lighting state, discarding every color if either one
+	  *  differs from the last call
+	  * @param geometry_ The mesh (or level of detail) which is being drawn
+	  * @param lighting_ Revision number of the lights of the scene
+	  * @param shadows_ Revision number of each shadow map which reaches the object
+	  */
+	void update(const mesh *geometry_, const unsigned long long &lighting_, const std::vector<unsigned long long> &shadows_){
+		const size_t nClusters = geometry_->getMeshlets().size();
+		if(geometry_ == geometry && lighting_ == lighting && shadows_ == shadows && shaded.size() == nClusters)
+			return;
+		geometry = geometry_;
+		lighting = lighting_;
+		shadows = shadows_;
+		colors.resize(geometry->getNumberOfTriangles() + vertexArray::BLOCK_SIZE); // Shading kernels write whole blocks
+		shaded.assign(nClusters, false);
+	}
+
+	/** Discard every color, so that all meshlets are shaded again the next time they are drawn
+	  */
+	void invalidate(){ geometry = NULL; }
+
+	/** Return true if the triangles of a meshlet have been shaded and return false otherwise
+	  * @param cluster The index of the meshlet in the mesh
+	  */
+	bool isShaded(const size_t &cluster) const { return shaded[cluster]; }
+
+	/** Flag the triangles of a meshlet as shaded
+	  */
+	void setShaded(const size_t &cluster){ shaded[cluster] = true; }
+
+	/** Get a pointer to the array of ARGB8888 colors, one per triangle, for use by the shading kernels
+	  */
+	unsigned int* getColors(){ return &colors[0]; }
+
+	/** Get the color of a triangle
+	  */
+	const unsigned int& operator [] (const size_t &index) const { return colors[index]; }
+
+private:
+	const mesh *geometry; ///< The mesh whose triangles are cached (NULL if the cache is empty)
+
+	unsigned long long lighting; ///< Revision number of the lights when the colors were computed
+
+	std::vector<unsigned long long> shadows; ///< Revision number of each shadow map which reached the object when the colors were computed
+
+	std::vector<unsigned int> colors; ///< Shaded ARGB8888 color of each triangle
+
+	std::vector<bool> shaded; ///< Flags indicating which meshlets have been shaded
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef SHADOW_MAP_HPP
+#define SHADOW_MAP_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "camera.hpp"
+#include "depthBuffer.hpp"
+
+class object;
+class mesh;
+class lightSource;
+
+const int DEFAULT_SHADOW_MAP_SIZE = 1024; ///< Default width and height of shadow maps (in pixels)
+
+const double DEFAULT_SHADOW_BIAS = 0.01; ///< Default distance by which a face must lie behind the shadow map to be shadowed (in m)
+
+/** @class shadowMap
+  * @brief Depth of the geometry closest to a light source, as seen from the light, used to find which faces it cannot reach
+  *
+  * The map is drawn from a camera aimed by the light source (see lightSource::getShadowCamera()), using the same
+  * view-projection matrices as the main camera, so depths are stored as the normalized reciprocal depth L/z. Only
+  * the depth is drawn, by a simple single-threaded rasterizer with no color output, and only the faces of each mesh
+  * which point away from the light are drawn. Closed meshes therefore never shadow their own lit faces, which
+  * removes the need for a large depth bias.
+  *
+  * A face is shadowed if its center-of-mass lies farther from the light than the depth stored in the map at the
+  * point where it projects, by more than the bias. Faces which project outside of the map are never shadowed.
+  *
+  * The revision number of the map changes every time it is drawn or invalidated, so shaded colors which depend on
+  * the map are kept only for as long as it stays the same.
+  */
+
+class shadowMap{
+public:
+	/** Default constructor (empty map)
+	  */
+	shadowMap() : size(0), bias(DEFAULT_SHADOW_BIAS), valid(false), revision(0) { }
+
+	/** Get the width and height of the map (in pixels)
+	  */
+	int getSize() const { return size; }
+
+	/** Get the distance by which a face must lie behind the map to be shadowed (in m)
+	  */
+	double getBias() const { return bias; }
+
+	/** Get the camera which the map was drawn from
+	  */
+	const camera* getCamera() const { return &cam; }
+
+	/** Return true if the map has been drawn since it was last invalidated and return false otherwise
+	  */
+	bool isValid() const { return valid; }
+
+	/** Get the number of times the map has been drawn or invalidated
+	  */
+	unsigned long long getRevision() const { return revision; }
+
+	/** Return true if the map was last aimed for a scene with the same bounding box and return false otherwise
+	  * @note The camera of a light source depends on the bounds of the scene (see lightSource::getShadowCamera())
+	  */
+	bool isAimedAt(const vector3 &sceneMin_, const vector3 &sceneMax_) const { return (sceneMin_ == sceneMin && sceneMax_ == sceneMax); }
+
+	/** Return true if the map is valid and its camera sees at least part of an axis-aligned box, and return false otherwise.
+	  *  Faces inside of a box which the map does not see are never shadowed by it
+	  * @param boxMin The minimum corner of the box (in real-space)
+	  * @param boxMax The maximum corner of the box (in real-space)
+	  */
+	bool reaches(const vector3 &boxMin, const vector3 &boxMax) const { return (valid && cam.checkFrustum(boxMin, boxMax)); }
+
+	/** Set the width and height of the map (in pixels)
+	  * @note The map is invalidated if its size changes
+	  */
+	void setSize(const int &size_);
+
+	/** Set the distance by which a face must lie behind the map to be shadowed (in m)
+	  */
+	void setBias(const double &bias_){ bias = bias_; }
+
+	/** Flag the map as out of date, so that no faces are shadowed by it until it is drawn again
+	  */
+	void invalidate(){
+		if(valid)
+			revision++;
+		valid = false;
+	}
+
+	/** Aim the map's camera from a light source so that it sees the whole scene
+	  * @param light The light source which casts the shadows
+	  * @param sceneMin The minimum corner of the box which bounds every object of the scene (in real-space)
+	  * @param sceneMax The maximum corner of the box which bounds every object of the scene (in real-space)
+	  * @return True if the camera was aimed and return false if the light source is unable to cast shadows
+	  */
+	bool setLight(const lightSource *light, const vector3 &sceneMin, const vector3 &sceneMax);
+
+	/** Clear the map and draw the depth of every object which casts shadows
+	  * @note Objects are drawn using their full meshes, regardless of the level of detail shown by the main camera
+	  */
+	void render(const std::vector<object*> &casters);
+
+	/** Compute the fraction of the light which reaches each face in a range of faces of an object
+	  * @param obj The object whose faces are tested
+	  * @param geometry The mesh (or level of detail) of the object which is being drawn
+	  * @param first Index of the first face to test
+	  * @param count Number of faces to test
+	  * @param visibility Array of visibility factors, indexed like the faces, where zero is shadowed and one is lit
+	  */
+	void computeVisibility(const object *obj, const mesh *geometry, const size_t &first, const size_t &count, float *visibility) const ;
+
+private:
+	camera cam; ///< The camera which the map is drawn from
+
+	depthBuffer depth; ///< Normalized reciprocal depth of the closest face drawn at each pixel
+
+	int size; ///< Width and height of the map (in pixels)
+
+	double bias; ///< Distance by which a face must lie behind the map to be shadowed (in m)
+
+	bool valid; ///< Flag indicating that the map has been drawn since it was last invalidated
+
+	unsigned long long revision; ///< Number of times the map has been drawn or invalidated
+
+	vector3 sceneMin; ///< Minimum corner of the box which bounded the scene when the camera was last aimed
+	vector3 sceneMax; ///< Maximum corner of the box which bounded the scene when the camera was last aimed
+
+	std::vector<float> pX; ///< Horizontal pixel coordinate of each vertex of the object currently being drawn
+	std::vector<float> pY; ///< Vertical pixel coordinate of each vertex of the object currently being drawn
+	std::vector<float> pZ; ///< Normalized reciprocal depth of each vertex of the object currently being drawn (zero if behind the camera)
+
+	std::vector<unsigned int> facing; ///< Bit mask of the faces of the object currently being drawn which point toward the light
+
+	/** Draw the depth of a triangle, keeping the closest depth at each pixel
+	  * @param i0 Index of the first vertex of the triangle
+	  * @param i1 Index of the second vertex of the triangle
+	  * @param i2 Index of the third vertex of the triangle
+	  */
+	void fillTriangle(const unsigned int &i0, const unsigned int &i1, const unsigned int &i2);
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/** @class threadPool
+  * @brief Fixed set of persistent worker threads used to run parallel-for style jobs
+  */
+
+class threadPool{
+public:
+	/** Default constructor (one thread per hardware thread)
+	  */
+	threadPool();
+
+	/** Constructor taking the total number of threads to use (including the calling thread)
+	  */
+	threadPool(const size_t &nThreads);
+
+	/** Destructor
+	  */
+	~threadPool();
+
+	/** Get the total number of threads used to run jobs (including the calling thread)
+	  */
+	size_t getNumberOfThreads() const { return workers.size()+1; }
+
+	/** Set the total number of threads used to run jobs (including the calling thread)
+	  * @note Passing zero will use one thread per hardware thread
+	  */
+	void setNumberOfThreads(const size_t &nThreads);
+
+	/** Call func(i) for every i in [0, N), distributing the calls over all threads, and return once every call has completed
+	  * @note The calling thread also executes jobs. Calls are claimed dynamically, so their order is not defined
+	  */
+	void run(const size_t &N, const std::function<void(const size_t&)> &func);
+
+private:
+	std::vector<std::thread> workers; ///< Worker threads (not including the calling thread)
+
+	std::mutex lock; ///< Mutex protecting the job state
+	std::condition_variable jobReady; ///< Signals the workers that a new job is available
+	std::condition_variable jobDone; ///< Signals the calling thread that all workers have finished the current job
+
+	const std::function<void(const size_t&)> *job; ///< The current job
+	size_t jobSize; ///< The number of calls in the current job
+	std::atomic<size_t> nextIndex; ///< The index of the next unclaimed call in the current job
+
+	unsigned long long generation; ///< Incremented each time a new job is started
+	size_t nBusy; ///< The number of workers still working on the current job
+	bool stop; ///< Flag indicating that all workers should exit
+
+	/** Start the worker threads
+	  */
+	void start(const size_t &nThreads);
+
+	/** Stop and join all worker threads
+	  */
+	void join();
+
+	/** Claim and execute calls from the current job until there are none left
+	  */
+	void work();
+
+	/** Main loop for each of the worker threads
+	  * @param lastGeneration The job generation at the time the thread was started
+	  */
+	void workerLoop(unsigned long long lastGeneration);
+};
+
+#endif
@@ -4,27 +4,28 @@
 #include "matrix3.hpp"
 #include "plane.hpp"
 
+/** @class triangle
+  * @brief The infinite plane which bounds a triangle, positioned at the triangle's center-of-mass
+  * @note The vertices of a triangle belonging to an object are found using mesh::getTriangle()
+  */
+
 class triangle : public plane {
 public:
-	const vector3* p0; ///< Pointer to one of the vertices
-	const vector3* p1; ///< Pointer to one of the vertices
-	const vector3* p2; ///< Pointer to one of the vertices
-
 	/** Default constructor
 	  */
-	triangle() : plane(), p0(), p1(), p2() { }
+	triangle() : plane() { }
 	
 	/** Vertex constructor
 	  */
-	triangle(const vector3 &p0_, const vector3 &p1_, const vector3 &p2_) : plane(p0_, p1_, p2_), p0(&p0_), p1(&p1_), p2(&p2_) { }
+	triangle(const vector3 &p0_, const vector3 &p1_, const vector3 &p2_) : plane(p0_, p1_, p2_) { }
 
 	/** Update the infinite plane which bounds this triangle. This method sets the "position" of the plane to the
 	  * center-of-mass of the three triangle vertices and computes the normal to the surface of the triangle
 	  * assuming clockwise orientation of @a p0, @a p1, and @a p2
 	  */
-	void update();
+	void update(const vector3 &p0, const vector3 &p1, const vector3 &p2);
 
-	/** Dump the vertex coordinates to stdout
+	/** Dump the center-of-mass and normal to stdout
 	  */
 	void dump() const ;
 };
@@ -1,157 +1,200 @@
 #ifndef VECTOR3_HPP
 #define VECTOR3_HPP
 
-class vector3{
+#include <cmath>
+
+/** @class vector3T
+  * @brief Three dimensional vector with a given scalar type
+  *
+  * All arithmetic is defined in this header so that it may be inlined everywhere. Use the vector3 (double)
+  * alias for scene-level math and the vector3f (float) alias for per-vertex data on the render path.
+  */
+
+template <typename T>
+class vector3T{
 public:
-	double x; ///< X coordinate
-	double y; ///< Y coordinate
-	double z; ///< Z coordinate
+	T x; ///< X coordinate
+	T y; ///< Y coordinate
+	T z; ///< Z coordinate
 
 	/** Default constructor (zero vector)
 	  */
-	vector3() : x(0), y(0), z(0) { }
-	
+	constexpr vector3T() : x(0), y(0), z(0) { }
+
 	/** 2d vector constructor
 	  */
-	vector3(const double &x_, const double &y_) : x(x_), y(y_), z(0) { }
-	
+	constexpr vector3T(const T &x_, const T &y_) : x(x_), y(y_), z(0) { }
+
 	/** 3d vector constructor
 	  */
-	vector3(const double &x_, const double &y_, const double &z_) : x(x_), y(y_), z(z_) { }
+	constexpr vector3T(const T &x_, const T &y_, const T &z_) : x(x_), y(y_), z(z_) { }
 
-	/** Copy constructor
+	/** Conversion constructor from a vector with a different scalar type
 	  */
-	vector3(const vector3 &other) : x(other.x), y(other.y), z(other.z) { }
+	template <typename U>
+	explicit constexpr vector3T(const vector3T<U> &other) : x((T)other.x), y((T)other.y), z((T)other.z) { }
 
-	/** Assignment operator
-	  */
-	vector3& operator = (const vector3 &rhs);
-	
 	/** Perform the dot product between this vector and another vector and return the result
 	  */
-	double operator * (const vector3 &rhs) const { return (rhs.x*x + rhs.y*y + rhs.z*z); }
-	
+	constexpr T operator * (const vector3T &rhs) const { return (rhs.x*x + rhs.y*y + rhs.z*z); }
+
 	/** Multiply this vector by a constant value and return the result
 	  */
-	vector3 operator * (const double &rhs) const { return vector3(x*rhs, y*rhs, z*rhs); }
+	constexpr vector3T operator * (const T &rhs) const { return vector3T(x*rhs, y*rhs, z*rhs); }
 
 	/** Divide this vector by a constant value and return the result
 	  */
-	vector3 operator / (const double &rhs) const { return vector3(x/rhs, y/rhs, z/rhs); }
+	constexpr vector3T operator / (const T &rhs) const { return vector3T(x/rhs, y/rhs, z/rhs); }
 
 	/** Add another vector to this vector and return the result
 	  */
-	vector3 operator + (const vector3 &rhs) const { return vector3(x+rhs.x, y+rhs.y, z+rhs.z); }
+	constexpr vector3T operator + (const vector3T &rhs) const { return vector3T(x+rhs.x, y+rhs.y, z+rhs.z); }
 
 	/** Subtract another vector from this vector and return the result
 	  */
-	vector3 operator - (const vector3 &rhs) const { return vector3(x-rhs.x, y-rhs.y, z-rhs.z); }
+	constexpr vector3T operator - (const vector3T &rhs) const { return vector3T(x-rhs.x, y-rhs.y, z-rhs.z); }
 
 	/** Equality operator
 	  */
-	bool operator == (const vector3 &rhs) const { return (x==rhs.x && y==rhs.y && z==rhs.z); }
+	constexpr bool operator == (const vector3T &rhs) const { return (x==rhs.x && y==rhs.y && z==rhs.z); }
 
 	/** Return true if the length of this vector is equal to a value and return false otherwise
 	  */
-	bool operator == (const double &rhs) const { return (length() == rhs); }
+	bool operator == (const T &rhs) const { return (length() == rhs); }
 
 	/** Inequality operator
 	  */
-	bool operator != (const vector3 &rhs) const { return (x!=rhs.x || y!=rhs.y || z!=rhs.z); }
+	constexpr bool operator != (const vector3T &rhs) const { return (x!=rhs.x || y!=rhs.y || z!=rhs.z); }
 
 	/** Return true if the length of this vector is not equal to a value and return false otherwise
 	  */
-	bool operator != (const double &rhs) const { return (length() != rhs); }
+	bool operator != (const T &rhs) const { return (length() != rhs); }
 
 	/** Return true if the length of this vector is greater than that of another vector and return false otherwise
 	  */
-	bool operator > (const vector3 &rhs) const { return (length() > rhs.length()); }
+	constexpr bool operator > (const vector3T &rhs) const { return (square() > rhs.square()); }
 
 	/** Return true if the length of this vector is greater than a value and return false otherwise
-	  */	
-	bool operator > (const double &rhs) const { return (length() > rhs); }
-	
+	  */
+	bool operator > (const T &rhs) const { return (length() > rhs); }
+
 	/** Return true if the length of this vector is less than that of another vector and return false otherwise
 	  */
-	bool operator < (const vector3 &rhs) const { return (length() < rhs.length()); }
+	constexpr bool operator < (const vector3T &rhs) const { return (square() < rhs.square()); }
 
 	/** Return true if the length of this vector is less than a value and return false otherwise
-	  */	
-	bool operator < (const double &rhs) const { return (length() < rhs); }
+	  */
+	bool operator < (const T &rhs) const { return (length() < rhs); }
 
 	/** Return true if the length of this vector is greater than or equal to that of another vector and return false otherwise
 	  */
-	bool operator >= (const vector3 &rhs) const { return (length() >= rhs.length()); }
+	constexpr bool operator >= (const vector3T &rhs) const { return (square() >= rhs.square()); }
 
 	/** Return true if the length of this vector is greater than or equal to a value and return false otherwise
-	  */	
-	bool operator >= (const double &rhs) const { return (length() >= rhs); }
+	  */
+	bool operator >= (const T &rhs) const { return (length() >= rhs); }
 
 	/** Return true if the length of this vector is less than or equal to that of another vector and return false otherwise
 	  */
-	bool operator <= (const vector3 &rhs) const { return (length() <= rhs.length()); }
+	constexpr bool operator <= (const vector3T &rhs) const { return (square() <= rhs.square()); }
 
 	/** Return true if the length of this vector is less than or equal to a value and return false otherwise
-	  */	
-	bool operator <= (const double &rhs) const { return (length() <= rhs); }
+	  */
+	bool operator <= (const T &rhs) const { return (length() <= rhs); }
 
 	/** Multiply this vector by a constant value and return the result
 	  */
-	vector3& operator *= (const double &rhs);
-	
+	vector3T& operator *= (const T &rhs){
+		x *= rhs;
+		y *= rhs;
+		z *= rhs;
+		return (*this);
+	}
+
 	/** Divide this vector by a constant value and return the result
 	  */
-	vector3& operator /= (const double &rhs);
-	
+	vector3T& operator /= (const T &rhs){
+		x /= rhs;
+		y /= rhs;
+		z /= rhs;
+		return (*this);
+	}
+
 	/** Add another vector to this vector and return the result
 	  */
-	vector3& operator += (const vector3 &rhs);
+	vector3T& operator += (const vector3T &rhs){
+		x += rhs.x;
+		y += rhs.y;
+		z += rhs.z;
+		return (*this);
+	}
 
 	/** Subtract another vector from this vector and return the result
 	  */
-	vector3& operator -= (const vector3 &rhs);
+	vector3T& operator -= (const vector3T &rhs){
+		x -= rhs.x;
+		y -= rhs.y;
+		z -= rhs.z;
+		return (*this);
+	}
 
 	/** Perform the cross-product of this and another vector and return the result
 	  */
-	vector3 cross(const vector3 &rhs) const ;
+	constexpr vector3T cross(const vector3T &rhs) const {
+		return vector3T((y*rhs.z - rhs.y*z),
+		                (rhs.x*z - x*rhs.z),
+		                (x*rhs.y - rhs.x*y));
+	}
 
 	/** Get a normalized version of this vector
 	  * @note Does not modify the coordinates of this vector
 	  */
-	vector3 normalize() const ;
+	vector3T normalize() const {
+		T mag = length();
+		return vector3T(x/mag, y/mag, z/mag);
+	}
 
 	/** Normalize this vector and return the result
 	  */
-	vector3& normInPlace();
+	vector3T& normInPlace(){
+		T mag = length();
+		x /= mag;
+		y /= mag;
+		z /= mag;
+		return (*this);
+	}
 
 	/** Return true if this vector has unit length and return false otherwise
 	  */
-	bool isUnit() const { return (square() == 1); }
+	constexpr bool isUnit() const { return (square() == 1); }
 
 	/** Return true if this is a zero vector and return false otherwise
 	  */
-	bool isZero() const { return (x==0 && y==0 && z==0); }
+	constexpr bool isZero() const { return (x==0 && y==0 && z==0); }
 
 	/** Compute the length of this vector
 	  */
-	double length() const ;
-	
+	T length() const { return std::sqrt(square()); }
+
 	/** Compute the square of the length of this vector
 	  */
-	double square() const { return (x*x+y*y+z*z); }
-	
+	constexpr T square() const { return (x*x+y*y+z*z); }
+
 	/** Zero all elements of this vector
 	  */
-	void zero();
-	
+	void zero(){ x = 0; y = 0; z = 0; }
+
 	/** Dump vector coordinates to stdout
 	  */
 	void dump() const ;
 };
 
-extern const vector3 zeroVector;
-extern const vector3 unitVectorX;
-extern const vector3 unitVectorY;
-extern const vector3 unitVectorZ;
+typedef vector3T<double> vector3; ///< Double precision vector used for scene-level math
+typedef vector3T<float> vector3f; ///< Single precision vector used on the render path
+
+constexpr vector3 zeroVector(0, 0, 0);
+constexpr vector3 unitVectorX(1, 0, 0);
+constexpr vector3 unitVectorY(0, 1, 0);
+constexpr vector3 unitVectorZ(0, 0, 1);
 
 #endif
@@ -0,0 +1,248 @@
+#ifndef VERTEX_ARRAY_HPP
+#define VERTEX_ARRAY_HPP
+
+#include <cstddef>
+
+#include "vector3.hpp"
+#include "colors.hpp"
+
+/** @class faceLight
+  * @brief Light source moved into the reference frame of a list of faces, in the form used by the shading kernels
+  */
+
+class faceLight{
+public:
+	/** Ways in which a light source may illuminate a face
+	  */
+	enum lightType {DIRECTIONAL, ///< Parallel rays along the direction, with the same intensity everywhere
+	                POINT,       ///< Rays outward from the position, falling off with distance
+	                CONE         ///< Rays outward from the position within a cone around the direction, falling off with distance
+	};
+
+	lightType type; ///< The way in which the light illuminates a face
+	vector3f position; ///< Position of the light source (POINT and CONE only)
+	vector3f direction; ///< Direction of the light rays (DIRECTIONAL) or axis of the cone (CONE)
+	linearColor color; ///< Color of the light, scaled by the brightness. One is full intensity
+	float rangeSquare; ///< Square of the distance beyond which faces receive no light (POINT and CONE only)
+	float cosHalfAngle; ///< Cosine of half of the opening angle of the cone (CONE only)
+	const float *visibility; ///< Fraction of the light which reaches each face, indexed like the faces (NULL if every face is fully exposed)
+
+	/** Default constructor (white directional light along the z-axis)
+	  */
+	faceLight() : type(DIRECTIONAL), position(), direction(0, 0, 1), color(1), rangeSquare(0), cosHalfAngle(1), visibility(NULL) { }
+};
+
+/** @class vertexArray
+  * @brief Structure-of-arrays storage for a list of 3d points in single precision
+  *
+  * The x, y, and z coordinates are kept in three separate arrays, each aligned to 32 bytes and padded
+  * to a whole number of blocks of BLOCK_SIZE elements, so that the SIMD kernels below may load and
+  * store complete vector registers without any tail handling. Padding elements are always valid numbers.
+  */
+
+class vertexArray{
+public:
+	/** Instruction sets which may be used by the vertex kernels
+	  */
+	enum simdLevel {SIMD_NONE, ///< Scalar code
+	                SIMD_SSE2, ///< SSE2 on four vertices at a time
+	                SIMD_AVX2  ///< AVX2 on eight vertices at a time
+	};
+
+	static const size_t ALIGNMENT = 32; ///< Alignment of each coordinate array (in bytes)
+	static const size_t BLOCK_SIZE = 8; ///< Each coordinate array holds a multiple of this many elements
+
+	/** Default constructor (empty array)
+	  */
+	vertexArray() : block(NULL), x(NULL), y(NULL), z(NULL), count(0), capacity(0) { }
+
+	/** Copy constructor
+	  */
+	vertexArray(const vertexArray &other);
+
+	/** Destructor
+	  */
+	~vertexArray();
+
+	/** Assignment operator
+	  * @note Reuses the existing storage if it is large enough
+	  */
+	vertexArray& operator = (const vertexArray &rhs);
+
+	/** Get the number of points in the array
+	  */
+	size_t size() const { return count; }
+
+	/** Return true if the array contains no points and return false otherwise
+	  */
+	bool empty() const { return (count == 0); }
+
+	/** Get a pointer to the array of x coordinates
+	  */
+	const float* getX() const { return x; }
+
+	/** Get a pointer to the array of y coordinates
+	  */
+	const float* getY() const { return y; }
+
+	/** Get a pointer to the array of z coordinates
+	  */
+	const float* getZ() const { return z; }
+
+	/** Get a pointer to the array of x coordinates
+	  */
+	float* getX(){ return x; }
+
+	/** Get a pointer to the array of y coordinates
+	  */
+	float* getY(){ return y; }
+
+	/** Get a pointer to the array of z coordinates
+	  */
+	float* getZ(){ return z; }
+
+	/** Get a single point from the array
+	  */
+	vector3f get(const size_t &index) const { return vector3f(x[index], y[index], z[index]); }
+
+	/** Set a single point in the array
+	  */
+	void set(const size_t &index, const vector3f &vec){ x[index] = vec.x; y[index] = vec.y; z[index] = vec.z; }
+
+	/** Add a point to the end of the array
+	  */
+	void push_back(const vector3f &vec);
+
+	/** Resize the array. New points are set to zero
+	  */
+	void resize(const size_t &size);
+
+	/** Make sure the array is able to hold a given number of points without reallocating
+	  */
+	void reserve(const size_t &size);
+
+	/** Remove all points from the array (does not release its storage)
+	  */
+	void clear(){ resize(0); }
+
+	/** Compute which of a list of faces, whose unit normals are stored in this array, face towards a point
+	  * @param centroids Array of the center-of-mass of each face (must be the same size as this array)
+	  * @param point The point to test against (in the same reference frame as the faces)
+	  * @param mask Bit mask with one bit per face, where bit i%32 of word i/32 is set if the point does not lie
+	  *             behind face i (must contain at least (size()+31)/32 elements)
+	  */
+	void computeFacing(const vertexArray &centroids, const vector3f &point, unsigned int *mask) const { computeFacing(centroids, point, 0, count, mask); }
+
+	/** Compute which of a range of faces, whose unit normals are stored in this array, face towards a point
+	  * @param centroids Array of the center-of-mass of each face (must be the same size as this array)
+	  * @param point The point to test against (in the same reference frame as the faces)
+	  * @param first Index of the first face to test (must be a multiple of 32)
+	  * @param nFaces Number of faces to test
+	  * @param mask Bit mask with one bit per face of the whole array (see above). Only the words which hold the
+	  *             range of faces are written
+	  */
+	void computeFacing(const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &nFaces, unsigned int *mask) const ;
+
+	/** Compute the color of a range of faces, whose unit normals are stored in this array, lit by a list of lights
+	  * @param centroids Array of the center-of-mass of each face (must be the same size as this array)
+	  * @param lights Array of lights (in the same reference frame as the faces)
+	  * @param nLights Number of lights
+	  * @param first Index of the first face to shade (must be a multiple of BLOCK_SIZE)
+	  * @param nFaces Number of faces to shade
+	  * @param srgb If set, the colors are sRGB encoded when they are packed (see linearColor::encodeSRGB())
+	  * @param colors Packed ARGB8888 color of each face of the whole array. Faces past the end of the range, up to the
+	  *               next multiple of BLOCK_SIZE, may also be written, so the array must have room for them
+	  */
+	void computeShading(const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &nFaces, const bool &srgb, unsigned int *colors) const ;
+
+	/** Compute the square of the largest distance from a point to any point in the array
+	  */
+	float getMaxSquareDistance(const vector3f &point) const ;
+
+	/** Get the instruction set currently used by the vertex kernels
+	  */
+	static simdLevel getSimdLevel();
+
+	/** Set the instruction set used by the vertex kernels
+	  * @note The level is lowered to the best one supported by the library and the CPU, if necessary
+	  */
+	static void setSimdLevel(const simdLevel &level);
+
+	/** Get the best instruction set supported by both the library and the CPU
+	  */
+	static simdLevel getSupportedSimdLevel();
+
+private:
+	float *block; ///< Unaligned storage for all three coordinate arrays
+	float *x; ///< Array of x coordinates
+	float *y; ///< Array of y coordinates
+	float *z; ///< Array of z coordinates
+
+	size_t count; ///< Number of points in the array
+	size_t capacity; ///< Number of points which may be stored without reallocating (multiple of BLOCK_SIZE)
+};
+
+/////////////////////////////////////////////////
+// Vertex kernels
+/////////////////////////////////////////////////
+
+/** Kernel which sets the bits of a mask for the faces, in the range [first, last), which face towards a point
+  * @note The mask must already be zeroed and first must be a multiple of 32. Bits past the end of the range,
+  *       within its last word, may be left set
+  */
+typedef void (*vertexFacingKernel)(const vertexArray &normals, const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask);
+
+/** Kernel which sums the light reaching each face in the range [first, last) in linear light and packs the result
+  *  into ARGB8888 colors, optionally sRGB encoded
+  * @note The first face must be a multiple of BLOCK_SIZE. Colors past the end of the range, within its last block,
+  *       may be written
+  */
+typedef void (*vertexShadeKernel)(const vertexArray &normals, const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors);
+
+/** Test one face at a time (available on all platforms)
+  */
+void computeFacingScalar(const vertexArray &normals, const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask);
+
+/** Test four faces at a time using SSE2
+  * @note Falls back to the scalar kernel if the library was built without SSE2 support
+  */
+void computeFacingSSE2(const vertexArray &normals, const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask);
+
+/** Test eight faces at a time using AVX2
+  * @note Falls back to the scalar kernel if the library was built without AVX2 support
+  */
+void computeFacingAVX2(const vertexArray &normals, const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask);
+
+/** AVX2 facing kernel on raw coordinate arrays, which must be padded to whole blocks (see computeFacingAVX2())
+  * @note Only available if vertexAVX2Compiled() returns true
+  */
+void computeFacingAVX2Raw(const float *nX, const float *nY, const float *nZ, const float *cX, const float *cY, const float *cZ, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask);
+
+/** Shade one face at a time (available on all platforms)
+  */
+void computeShadingScalar(const vertexArray &normals, const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors);
+
+/** Shade four faces at a time using SSE2
+  * @note Falls back to the scalar kernel if the library was built without SSE2 support
+  */
+void computeShadingSSE2(const vertexArray &normals, const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors);
+
+/** Shade eight faces at a time using AVX2
+  * @note Falls back to the scalar kernel if the library was built without AVX2 support
+  */
+void computeShadingAVX2(const vertexArray &normals, const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors);
+
+/** AVX2 shading kernel on raw coordinate arrays, which must be padded to whole blocks (see computeShadingAVX2())
+  * @note Only available if vertexAVX2Compiled() returns true
+  */
+void computeShadingAVX2Raw(const float *nX, const float *nY, const float *nZ, const float *cX, const float *cY, const float *cZ, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors);
+
+/** Return true if the SSE2 vertex kernels were compiled into the library and return false otherwise
+  */
+bool vertexSSE2Compiled();
+
+/** Return true if the AVX2 vertex kernels were compiled into the library and return false otherwise
+  */
+bool vertexAVX2Compiled();
+
+#endif
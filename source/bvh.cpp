@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <limits>
+
+#include "bvh.hpp"
+#include "object.hpp"
+#include "camera.hpp"
+
+/** Compute the surface area of an axis-aligned box
+  */
+static double boxArea(const vector3 &boxMin, const vector3 &boxMax){
+	vector3 d = boxMax - boxMin;
+	return 2*(d.x*d.y + d.y*d.z + d.z*d.x);
+}
+
+/** Compute the surface area of the union of two axis-aligned boxes
+  */
+static double unionArea(const vector3 &minA, const vector3 &maxA, const vector3 &minB, const vector3 &maxB){
+	vector3 boxMin(std::min(minA.x, minB.x), std::min(minA.y, minB.y), std::min(minA.z, minB.z));
+	vector3 boxMax(std::max(maxA.x, maxB.x), std::max(maxA.y, maxB.y), std::max(maxA.z, maxB.z));
+	return boxArea(boxMin, boxMax);
+}
+
+/** Return true if box A lies entirely inside box B and return false otherwise
+  */
+static bool boxContains(const vector3 &minA, const vector3 &maxA, const vector3 &minB, const vector3 &maxB){
+	return (minA.x >= minB.x && minA.y >= minB.y && minA.z >= minB.z &&
+	        maxA.x <= maxB.x && maxA.y <= maxB.y && maxA.z <= maxB.z);
+}
+
+/** Return true if two axis-aligned boxes overlap and return false otherwise
+  */
+static bool boxOverlaps(const vector3 &minA, const vector3 &maxA, const vector3 &minB, const vector3 &maxB){
+	return (minA.x <= maxB.x && maxA.x >= minB.x &&
+	        minA.y <= maxB.y && maxA.y >= minB.y &&
+	        minA.z <= maxB.z && maxA.z >= minB.z);
+}
+
+/** Compute the distance along a ray to the point where it enters an axis-aligned box (slab test)
+  * @param r The ray
+  * @param invDir The reciprocal of each component of the ray's direction
+  * @param boxMin The minimum corner of the box
+  * @param boxMax The maximum corner of the box
+  * @param tMax Only intersections closer than this distance are considered
+  * @param tEnter The distance at which the ray enters the box (zero if the ray starts inside it)
+  * @return True if the ray intersects the box and return false otherwise
+  */
+static bool rayBox(const ray &r, const vector3 &invDir, const vector3 &boxMin, const vector3 &boxMax, const double &tMax, double &tEnter){
+	double t0 = 0, t1 = tMax;
+	const double origin[3] = {r.pos.x, r.pos.y, r.pos.z};
+	const double inverse[3] = {invDir.x, invDir.y, invDir.z};
+	const double lower[3] = {boxMin.x, boxMin.y, boxMin.z};
+	const double upper[3] = {boxMax.x, boxMax.y, boxMax.z};
+	for(size_t i = 0; i < 3; i++){
+		double tNear = (lower[i] - origin[i])*inverse[i];
+		double tFar = (upper[i] - origin[i])*inverse[i];
+		if(tNear > tFar)
+			std::swap(tNear, tFar);
+		t0 = std::max(t0, tNear);
+		t1 = std::min(t1, tFar);
+		if(t0 > t1)
+			return false;
+	}
+	tEnter = t0;
+	return true;
+}
+
+bvh::bvh() : root(-1), freeList(-1), nObjects(0), margin(DEFAULT_BVH_MARGIN) {
+}
+
+bvh::~bvh(){
+	clear();
+}
+
+void bvh::insert(object *obj){
+	if(obj->tree == this)
+		return;
+	if(obj->tree) // Object belongs to another tree
+		obj->tree->remove(obj);
+	
+	int leaf = allocateNode();
+	node &n = nodes[leaf];
+	vector3 fat(margin, margin, margin);
+	n.boxMin = obj->getBoundingBoxMin() - fat;
+	n.boxMax = obj->getBoundingBoxMax() + fat;
+	n.obj = obj;
+	obj->tree = this;
+	obj->treeNode = leaf;
+	insertLeaf(leaf);
+	addChange(n.boxMin, n.boxMax);
+	nObjects++;
+}
+
+void bvh::remove(object *obj){
+	if(obj->tree != this)
+		return;
+	addChange(nodes[obj->treeNode].boxMin, nodes[obj->treeNode].boxMax);
+	removeLeaf(obj->treeNode);
+	freeNode(obj->treeNode);
+	obj->tree = NULL;
+	obj->treeNode = -1;
+	nObjects--;
+}
+
+void bvh::update(object *obj){
+	if(obj->tree != this)
+		return;
+	
+	// The enlarged box holds the object before and after the move, even if the tree does not need to change
+	int leaf = obj->treeNode;
+	addChange(nodes[leaf].boxMin, nodes[leaf].boxMax);
+	
+	// Nothing more to do as long as the object is still inside of its enlarged box
+	vector3 boxMin = obj->getBoundingBoxMin();
+	vector3 boxMax = obj->getBoundingBoxMax();
+	if(boxContains(boxMin, boxMax, nodes[leaf].boxMin, nodes[leaf].boxMax))
+		return;
+	
+	// Re-insert the leaf with its new bounding box
+	removeLeaf(leaf);
+	vector3 fat(margin, margin, margin);
+	nodes[leaf].boxMin = boxMin - fat;
+	nodes[leaf].boxMax = boxMax + fat;
+	insertLeaf(leaf);
+	addChange(nodes[leaf].boxMin, nodes[leaf].boxMax);
+}
+
+void bvh::rebuild(){
+	if(root < 0)
+		return;
+	
+	// Gather all leaves, refreshing their boxes, and free all internal nodes
+	std::vector<int> leaves;
+	leaves.reserve(nObjects);
+	vector3 fat(margin, margin, margin);
+	for(size_t i = 0; i < nodes.size(); i++){
+		node &n = nodes[i];
+		if(n.obj){
+			n.boxMin = n.obj->getBoundingBoxMin() - fat;
+			n.boxMax = n.obj->getBoundingBoxMax() + fat;
+			leaves.push_back((int)i);
+		}
+		else if(n.left >= 0) // Internal node
+			freeNode((int)i);
+	}
+	
+	root = build(&leaves[0], leaves.size());
+	nodes[root].parent = -1;
+}
+
+void bvh::clear(){
+	if(root >= 0) // Every object is removed
+		addChange(nodes[root].boxMin, nodes[root].boxMax);
+	for(std::vector<node>::iterator iter = nodes.begin(); iter != nodes.end(); iter++){
+		if(iter->obj){
+			iter->obj->tree = NULL;
+			iter->obj->treeNode = -1;
+		}
+	}
+	nodes.clear();
+	root = -1;
+	freeList = -1;
+	nObjects = 0;
+}
+
+void bvh::queryFrustum(const camera *cam, std::vector<object*> &output) const {
+	if(root < 0)
+		return;
+	
+	// Each entry holds a node index and a bit mask of the frustum planes which its box still
+	//  crosses. Once a box is entirely inside of a plane, none of its descendants need to test it
+	std::vector<std::pair<int, unsigned int> > stack;
+	stack.push_back(std::make_pair(root, 0x3Fu));
+	while(!stack.empty()){
+		int index = stack.back().first;
+		unsigned int mask = stack.back().second;
+		stack.pop_back();
+		
+		const node &n = nodes[index];
+		bool outside = false;
+		for(size_t i = 0; i < 6 && !outside; i++){
+			if(!(mask & (1u << i)))
+				continue;
+			const plane &pl = cam->getFrustumPlane((frustumPlane)i);
+			
+			// Test the corners of the box which are furthest along and against the plane's normal
+			vector3 outer((pl.norm.x >= 0 ? n.boxMax.x : n.boxMin.x), (pl.norm.y >= 0 ? n.boxMax.y : n.boxMin.y), (pl.norm.z >= 0 ? n.boxMax.z : n.boxMin.z));
+			vector3 inner((pl.norm.x >= 0 ? n.boxMin.x : n.boxMax.x), (pl.norm.y >= 0 ? n.boxMin.y : n.boxMax.y), (pl.norm.z >= 0 ? n.boxMin.z : n.boxMax.z));
+			if(pl.distance(outer) < 0) // Box is entirely outside this plane
+				outside = true;
+			else if(pl.distance(inner) >= 0) // Box is entirely inside this plane
+				mask &= ~(1u << i);
+		}
+		if(outside)
+			continue;
+		
+		if(n.isLeaf()){
+			// The enlarged box may be visible while the object itself is not
+			if(mask == 0 || (cam->checkFrustum(n.obj->getBoundingSphereCenter(), n.obj->getBoundingSphereRadius()) &&
+			                 cam->checkFrustum(n.obj->getBoundingBoxMin(), n.obj->getBoundingBoxMax())))
+				output.push_back(n.obj);
+			continue;
+		}
+		stack.push_back(std::make_pair(n.right, mask));
+		stack.push_back(std::make_pair(n.left, mask));
+	}
+}
+
+void bvh::queryBox(const vector3 &boxMin, const vector3 &boxMax, std::vector<object*> &output) const {
+	if(root < 0)
+		return;
+	std::vector<int> stack(1, root);
+	while(!stack.empty()){
+		const node &n = nodes[stack.back()];
+		stack.pop_back();
+		if(!boxOverlaps(n.boxMin, n.boxMax, boxMin, boxMax))
+			continue;
+		if(n.isLeaf()){
+			if(boxOverlaps(n.obj->getBoundingBoxMin(), n.obj->getBoundingBoxMax(), boxMin, boxMax))
+				output.push_back(n.obj);
+			continue;
+		}
+		stack.push_back(n.right);
+		stack.push_back(n.left);
+	}
+}
+
+object* bvh::raycast(const ray &r, double &t) const {
+	object *closest = NULL;
+	if(root < 0)
+		return closest;
+	
+	vector3 invDir(1/r.dir.x, 1/r.dir.y, 1/r.dir.z);
+	double tBest = std::numeric_limits<double>::max();
+	std::vector<int> stack(1, root);
+	while(!stack.empty()){
+		const node &n = nodes[stack.back()];
+		stack.pop_back();
+		double tEnter;
+		if(!rayBox(r, invDir, n.boxMin, n.boxMax, tBest, tEnter))
+			continue;
+		if(n.isLeaf()){
+			double tHit;
+			if(n.obj->intersects(r, tHit) && tHit < tBest){
+				tBest = tHit;
+				closest = n.obj;
+			}
+			continue;
+		}
+		stack.push_back(n.right);
+		stack.push_back(n.left);
+	}
+	if(closest)
+		t = tBest;
+	return closest;
+}
+
+int bvh::allocateNode(){
+	if(freeList < 0){
+		nodes.push_back(node());
+		freeList = (int)nodes.size()-1;
+		nodes.back().parent = -1;
+	}
+	int index = freeList;
+	node &n = nodes[index];
+	freeList = n.parent;
+	n.parent = -1;
+	n.left = -1;
+	n.right = -1;
+	n.obj = NULL;
+	return index;
+}
+
+void bvh::freeNode(const int &index){
+	node &n = nodes[index];
+	n.parent = freeList;
+	n.left = -1;
+	n.right = -1;
+	n.obj = NULL;
+	freeList = index;
+}
+
+void bvh::addChange(const vector3 &boxMin, const vector3 &boxMax){
+	if(changes.size() < MAX_BVH_CHANGES){
+		changes.push_back(region(boxMin, boxMax));
+		return;
+	}
+	
+	// Too many regions to test one by one, so replace all of them with the box which encloses them
+	region merged(boxMin, boxMax);
+	for(std::vector<region>::const_iterator iter = changes.begin(); iter != changes.end(); iter++){
+		merged.boxMin = vector3(std::min(merged.boxMin.x, iter->boxMin.x), std::min(merged.boxMin.y, iter->boxMin.y), std::min(merged.boxMin.z, iter->boxMin.z));
+		merged.boxMax = vector3(std::max(merged.boxMax.x, iter->boxMax.x), std::max(merged.boxMax.y, iter->boxMax.y), std::max(merged.boxMax.z, iter->boxMax.z));
+	}
+	changes.assign(1, merged);
+}
+
+bool bvh::getBounds(vector3 &boxMin, vector3 &boxMax) const {
+	if(root < 0)
+		return false;
+	boxMin = nodes[root].boxMin;
+	boxMax = nodes[root].boxMax;
+	return true;
+}
+
+void bvh::insertLeaf(const int &leaf){
+	if(root < 0){
+		root = leaf;
+		nodes[root].parent = -1;
+		return;
+	}
+	
+	// Descend the tree, choosing the child which increases the total surface area the least, until
+	//  it is cheaper to create a new parent for the current node than to descend any further
+	const vector3 leafMin = nodes[leaf].boxMin;
+	const vector3 leafMax = nodes[leaf].boxMax;
+	int index = root;
+	while(!nodes[index].isLeaf()){
+		const node &n = nodes[index];
+		double area = boxArea(n.boxMin, n.boxMax);
+		double combined = unionArea(n.boxMin, n.boxMax, leafMin, leafMax);
+		
+		// Cost of creating a new parent for this node and the leaf
+		double cost = 2*combined;
+		
+		// Minimum cost of pushing the leaf further down the tree
+		double inheritance = 2*(combined - area);
+		double childCost[2];
+		const int children[2] = {n.left, n.right};
+		for(size_t i = 0; i < 2; i++){
+			const node &child = nodes[children[i]];
+			childCost[i] = unionArea(child.boxMin, child.boxMax, leafMin, leafMax) + inheritance;
+			if(!child.isLeaf())
+				childCost[i] -= boxArea(child.boxMin, child.boxMax);
+		}
+		if(cost < childCost[0] && cost < childCost[1])
+			break;
+		index = (childCost[0] < childCost[1] ? n.left : n.right);
+	}
+	
+	// Create a new parent for the sibling and the leaf
+	int sibling = index;
+	int oldParent = nodes[sibling].parent;
+	int newParent = allocateNode(); // May reallocate the nodes, so no references are held across this call
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].left = sibling;
+	nodes[newParent].right = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+	if(oldParent < 0)
+		root = newParent;
+	else if(nodes[oldParent].left == sibling)
+		nodes[oldParent].left = newParent;
+	else
+		nodes[oldParent].right = newParent;
+	
+	refit(newParent);
+}
+
+void bvh::removeLeaf(const int &leaf){
+	if(leaf == root){
+		root = -1;
+		return;
+	}
+	
+	// Replace the parent of the leaf with the leaf's sibling
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = (nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left);
+	if(grandParent < 0){
+		root = sibling;
+		nodes[sibling].parent = -1;
+	}
+	else{
+		if(nodes[grandParent].left == parent)
+			nodes[grandParent].left = sibling;
+		else
+			nodes[grandParent].right = sibling;
+		nodes[sibling].parent = grandParent;
+		refit(grandParent);
+	}
+	freeNode(parent);
+	nodes[leaf].parent = -1;
+}
+
+void bvh::refit(int index){
+	while(index >= 0){
+		node &n = nodes[index];
+		const node &left = nodes[n.left];
+		const node &right = nodes[n.right];
+		n.boxMin = vector3(std::min(left.boxMin.x, right.boxMin.x), std::min(left.boxMin.y, right.boxMin.y), std::min(left.boxMin.z, right.boxMin.z));
+		n.boxMax = vector3(std::max(left.boxMax.x, right.boxMax.x), std::max(left.boxMax.y, right.boxMax.y), std::max(left.boxMax.z, right.boxMax.z));
+		index = n.parent;
+	}
+}
+
+int bvh::build(int *leaves, const size_t &count){
+	if(count == 1)
+		return leaves[0];
+	
+	// Find the longest axis of the box enclosing the centers of all leaves
+	vector3 centerMin = (nodes[leaves[0]].boxMin + nodes[leaves[0]].boxMax)*0.5;
+	vector3 centerMax = centerMin;
+	for(size_t i = 1; i < count; i++){
+		vector3 center = (nodes[leaves[i]].boxMin + nodes[leaves[i]].boxMax)*0.5;
+		centerMin = vector3(std::min(centerMin.x, center.x), std::min(centerMin.y, center.y), std::min(centerMin.z, center.z));
+		centerMax = vector3(std::max(centerMax.x, center.x), std::max(centerMax.y, center.y), std::max(centerMax.z, center.z));
+	}
+	vector3 extent = centerMax - centerMin;
+	int axis = (extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2));
+	
+	// Split the leaves in half at the median center along that axis
+	size_t half = count/2;
+	std::nth_element(leaves, leaves+half, leaves+count, [this, axis](const int &a, const int &b){
+		const node &nA = nodes[a];
+		const node &nB = nodes[b];
+		switch(axis){
+			case 0:
+				return (nA.boxMin.x + nA.boxMax.x < nB.boxMin.x + nB.boxMax.x);
+			case 1:
+				return (nA.boxMin.y + nA.boxMax.y < nB.boxMin.y + nB.boxMax.y);
+			default:
+				return (nA.boxMin.z + nA.boxMax.z < nB.boxMin.z + nB.boxMax.z);
+		}
+	});
+	int left = build(leaves, half);
+	int right = build(leaves+half, count-half);
+	
+	int index = allocateNode();
+	node &n = nodes[index];
+	n.left = left;
+	n.right = right;
+	nodes[left].parent = index;
+	nodes[right].parent = index;
+	n.boxMin = vector3(std::min(nodes[left].boxMin.x, nodes[right].boxMin.x), std::min(nodes[left].boxMin.y, nodes[right].boxMin.y), std::min(nodes[left].boxMin.z, nodes[right].boxMin.z));
+	n.boxMax = vector3(std::max(nodes[left].boxMax.x, nodes[right].boxMax.x), std::max(nodes[left].boxMax.y, nodes[right].boxMax.y), std::max(nodes[left].boxMax.z, nodes[right].boxMax.z));
+	return index;
+}
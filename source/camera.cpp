@@ -43,6 +43,11 @@ void camera::setAspectRatio(const double &ratio){
 	computeViewingPlane();
 }
 
+void camera::setViewDistance(const double &dist){
+	viewDistance = dist;
+	updateViewProjection();
+}
+
 /////////////////////////////////////////////////
 // Movement methods
 /////////////////////////////////////////////////
@@ -87,78 +92,115 @@ void camera::moveTo(const double &x, const double &y, const double &z){
 /////////////////////////////////////////////////
 
 void camera::rotate(const double &theta, const double &phi, const double &psi){
-	// Get the rotation matrix
-	matrix3 rot(theta, phi, psi);
-	
-	// Update the rotation of the three unit vectors
-	rot.transform(uX);
-	rot.transform(uY);
-	rot.transform(uZ);
+	rotate(quaternion(theta, phi, psi));
+}
+
+void camera::rotate(const quaternion &rotation){
+	// Apply the rotation on top of the current orientation. Re-normalizing keeps the orientation a pure
+	//  rotation no matter how many small rotations are accumulated
+	orient = rotation*orient;
+	orient.normInPlace();
+	basisChanged = true;
 	
 	// Update the viewing plane
 	updateViewingPlane();
 }
 
 void camera::setRotation(const double &theta, const double &phi, const double &psi){
-	// Reset the camera to its original orientation
-	resetRotation();
-	
-	// Set the new rotation
-	rotate(theta, phi, psi);
+	setRotation(quaternion(theta, phi, psi));
+}
+
+void camera::setRotation(const quaternion &orientation){
+	orient = orientation.normalize();
+	basisChanged = true;
+	updateViewingPlane();
 }
 
 void camera::lookAt(const vector3 &position){
 	// Point the Z axis unit vector at the point in space
-	uZ = (position - pos).normalize();
+	vector3 axisZ = (position - pos).normalize();
 
-	// Compute the Y-axis unit vector  	
-	matrix3 pitch = matrix3::getPitchMatrix(std::acos(uZ.y) - pi/2);
-	uY = upVector;
-	pitch.transform(uY);
+	// Keep the X axis horizontal, unless looking straight up or down, where the current X axis is kept instead
+	vector3 axisX = upVector.cross(axisZ);
+	if(axisX.square() < 1E-12)
+		axisX = uX - axisZ*(uX*axisZ);
+	axisX.normInPlace();
 	
-	// Get the X-axis unit vector by computing the cross product of the Y and Z vectors
-	uX = uY.cross(uZ);
+	// Get the Y-axis unit vector by computing the cross product of the Z and X vectors
+	vector3 axisY = axisZ.cross(axisX);
 	
-	// Update the viewing plane
-	updateViewingPlane();
+	// The three unit vectors are the columns of the rotation matrix
+	matrix3 basis;
+	basis.elements[0][0] = axisX.x; basis.elements[0][1] = axisY.x; basis.elements[0][2] = axisZ.x;
+	basis.elements[1][0] = axisX.y; basis.elements[1][1] = axisY.y; basis.elements[1][2] = axisZ.y;
+	basis.elements[2][0] = axisX.z; basis.elements[2][1] = axisY.z; basis.elements[2][2] = axisZ.z;
+	setRotation(quaternion(basis));
 }
 
 void camera::resetRotation(){
-	uX = vector3(1, 0, 0);
-	uY = vector3(0, 1, 0);
-	uZ = vector3(0, 0, 1);
+	orient.identity();
+	basisChanged = true;
+	updateViewingPlane();
 }
 
 /////////////////////////////////////////////////
 // Rendering methods
 /////////////////////////////////////////////////
 
-void camera::render(const vector3 &offset, const triangle &tri, double *sX, double *sY, bool *valid){
-	valid[0] = projectPoint(*tri.p0+offset, sX[0], sY[0]);
-	valid[1] = projectPoint(*tri.p1+offset, sX[1], sY[1]);
-	valid[2] = projectPoint(*tri.p2+offset, sX[2], sY[2]);
+void camera::render(const vector3 &offset, const vector3 *verts, double *sX, double *sY, double *sZ, bool *valid){
+	valid[0] = projectPoint(verts[0]+offset, sX[0], sY[0], sZ[0]);
+	valid[1] = projectPoint(verts[1]+offset, sX[1], sY[1], sZ[1]);
+	valid[2] = projectPoint(verts[2]+offset, sX[2], sY[2], sZ[2]);
 }
 
-bool camera::checkCulling(const vector3 &offset, const triangle &tri){
-	// Check if the triangle is facing towards the camera
-	return (((tri.p+offset) - pos) * tri.norm <= 0);
+ray camera::getRay(const double &sX, const double &sY) const {
+	// The unit vectors are orthonormal, so the direction uZ + x*uX + y*uY is at (x, y, 1) in the
+	//  camera's reference frame and projects onto (sX, sY)
+	double x = sX*W/(2*L);
+	double y = sY*H/(2*L);
+	return ray(pos, uZ + uX*x + uY*y);
 }
 
-bool camera::projectPoint(const vector3 &vertex, double &sX, double &sY){
-	ray proj(vertex, pos-vertex);
-	
-	double t;
-	if(vPlane.intersects(proj, t)){
-		// Get the point at which the ray intersect the viewing plane
-		vector3 pp = proj.extend(t) - vPlane.p;
+bool camera::checkFrustum(const vector3 &center, const double &radius) const {
+	for(size_t i = 0; i < 6; i++){
+		if(frustum[i].distance(center) < -radius) // Sphere is entirely outside this plane
+			return false;
+	}
+	return true;
+}
 
-		// Convert the viewing plane point to screen space (-1, 1)
-		convertToScreenSpace(pp, sX, sY);
-		
-		return true;
+bool camera::checkFrustum(const vector3 &boxMin, const vector3 &boxMax) const {
+	for(size_t i = 0; i < 6; i++){
+		// Test the corner of the box which is furthest along the plane's normal
+		const vector3 &norm = frustum[i].norm;
+		vector3 corner((norm.x >= 0 ? boxMax.x : boxMin.x), (norm.y >= 0 ? boxMax.y : boxMin.y), (norm.z >= 0 ? boxMax.z : boxMin.z));
+		if(frustum[i].distance(corner) < 0) // Box is entirely outside this plane
+			return false;
 	}
+	return true;
+}
+
+bool camera::projectPoint(const vector3 &vertex, double &sX, double &sY){
+	double sZ;
+	return projectPoint(vertex, sX, sY, sZ);
+}
+
+bool camera::projectPoint(const vector3 &vertex, double &sX, double &sY, double &sZ){
+	// Transform the vertex into clip-space
+	double x, y, z, w;
+	viewProj.transform(vertex, x, y, z, w);
 	
-	return false;
+	// Check that the vertex is in front of the viewing plane
+	if(w <= L)
+		return false;
+	
+	// Perspective divide to screen-space (-1, 1) and the normalized reciprocal depth
+	double invW = 1/w;
+	sX = x*invW;
+	sY = y*invW;
+	sZ = z*invW;
+	
+	return true;
 }
 
 void camera::dump() const {
@@ -177,6 +219,7 @@ void camera::initialize(){
 	fov = pi/2; // radians
 	L = 50E-3; // m
 	A = 640.0/480; // unitless
+	viewDistance = 1000; // m
 	resetRotation();
 
 	// Setup the viewing plane (looking down the Z-axis)
@@ -189,16 +232,60 @@ void camera::initialize(){
 void camera::computeViewingPlane(){
 	W = 2*L*std::tan(fov/2); // m
 	H = W/A; // m
+	
+	// Scale x and y so that the edges of the viewing plane map to screen-space (-1, 1) after the
+	//  perspective divide. The constant z row makes z/w equal to the normalized reciprocal depth
+	proj = matrix4(2*L/W,     0, 0, 0,
+	                   0, 2*L/H, 0, 0,
+	                   0,     0, 0, L,
+	                   0,     0, 1, 0);
+	updateViewProjection();
+}
+
+void camera::updateViewProjection(){
+	viewProj = proj*view;
+	
+	// Extract the frustum planes from the rows of the view-projection matrix. Each plane is a
+	//  combination of rows which is non-negative for points inside the frustum (e.g. w + x >= 0)
+	const double (*m)[4] = viewProj.elements;
+	double coeff[6][4];
+	for(size_t j = 0; j < 4; j++){
+		coeff[FRUSTUM_LEFT][j]   = m[3][j] + m[0][j];
+		coeff[FRUSTUM_RIGHT][j]  = m[3][j] - m[0][j];
+		coeff[FRUSTUM_BOTTOM][j] = m[3][j] + m[1][j];
+		coeff[FRUSTUM_TOP][j]    = m[3][j] - m[1][j];
+		coeff[FRUSTUM_NEAR][j]   = m[3][j] - m[2][j];
+		coeff[FRUSTUM_FAR][j]    = -m[3][j];
+	}
+	coeff[FRUSTUM_FAR][3] += viewDistance;
+	for(size_t i = 0; i < 6; i++){
+		vector3 norm(coeff[i][0], coeff[i][1], coeff[i][2]);
+		double length = norm.length();
+		if(length == 0) // Projection has not been computed yet
+			continue;
+		frustum[i].norm = norm/length;
+		frustum[i].p = frustum[i].norm*(-coeff[i][3]/length);
+	}
 }
 
 void camera::updateViewingPlane(){
+	if(basisChanged){ // The unit vectors are the columns of the orientation's rotation matrix
+		matrix3 basis = orient.getMatrix();
+		uX = vector3(basis.elements[0][0], basis.elements[1][0], basis.elements[2][0]);
+		uY = vector3(basis.elements[0][1], basis.elements[1][1], basis.elements[2][1]);
+		uZ = vector3(basis.elements[0][2], basis.elements[1][2], basis.elements[2][2]);
+		basisChanged = false;
+	}
+
 	vPlane.p = pos + uZ*L;
 	vPlane.norm = uZ;
-}
-
-void camera::convertToScreenSpace(const vector3 &vec, double &x, double &y){
-	x = 2*(vec * uX)/W; // unitless
-	y = 2*(vec * uY)/H; // unitless
+	
+	// Project real-space points onto the camera's unit vectors, relative to its position
+	view = matrix4(uX.x, uX.y, uX.z, -(uX*pos),
+	               uY.x, uY.y, uY.z, -(uY*pos),
+	               uZ.x, uZ.y, uZ.z, -(uZ*pos),
+	                  0,    0,    0,         1);
+	updateViewProjection();
 }
 
 bool camera::rayTrace(const double &sX, const double &sY, const triangle &tri, vector3 &P){
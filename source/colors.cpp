@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cmath>
 
 #include "colors.hpp"
 
@@ -25,7 +26,7 @@ sdlColor sdlColor::operator - (const sdlColor &rhs) const {
 	float rprime = (r - rhs.r)/255.0;
 	float gprime = (g - rhs.g)/255.0;
 	float bprime = (b - rhs.b)/255.0;
-	return sdlColor((rprime > 0 ? rprime : 0), (gprime > 1 ? gprime : 0), (bprime > 1 ? bprime : 0));
+	return sdlColor((rprime > 0 ? rprime : 0), (gprime > 0 ? gprime : 0), (bprime > 0 ? bprime : 0));
 }
 
 sdlColor sdlColor::operator * (const float &rhs) const {
@@ -66,3 +67,34 @@ void sdlColor::toGrayscale(){
 void sdlColor::dump() const {
 	std::cout << "r=" << (int)r << ", g=" << (int)g << ", b=" << (int)b << std::endl;
 }
+
+sdlColor linearColor::toColor(const bool &srgb/*=false*/) const {
+	if(srgb)
+		return sdlColor(encodeSRGB(clamp(r)), encodeSRGB(clamp(g)), encodeSRGB(clamp(b)));
+	return sdlColor(clamp(r), clamp(g), clamp(b));
+}
+
+unsigned int linearColor::toARGB(const bool &srgb/*=false*/) const {
+	return toColor(srgb).toARGB(clamp(a));
+}
+
+linearColor linearColor::fromSRGB(const sdlColor &color){
+	return linearColor(decodeSRGB(sdlColor::toFloat(color.r)), decodeSRGB(sdlColor::toFloat(color.g)), decodeSRGB(sdlColor::toFloat(color.b)));
+}
+
+float linearColor::encodeSRGB(const float &value){
+	if(value <= 0.0031308f) // Linear segment near black
+		return 12.92f*value;
+	
+	// Fit of the power curve to the square, fourth, and eighth roots of the value
+	float root2 = std::sqrt(value);
+	float root4 = std::sqrt(root2);
+	float root8 = std::sqrt(root4);
+	return 0.662002687f*root2 + 0.684122060f*root4 - 0.323583601f*root8 - 0.0225411470f*value;
+}
+
+float linearColor::decodeSRGB(const float &value){
+	if(value <= 0.04045f)
+		return value/12.92f;
+	return std::pow((value + 0.055f)/1.055f, 2.4f);
+}
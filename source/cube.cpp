@@ -1,31 +1,58 @@
+#include <map>
+#include <mutex>
+#include <tuple>
+
 #include "cube.hpp"
 
-cube::cube(const vector3 &pos_, const double &X, const double &Y, const double &Z) : object(pos_), hX(X/2), hY(Y/2), hZ(Z/2) {
-	build();
+cube::cube(const vector3 &pos_, const double &X, const double &Y, const double &Z) : object(getBoxMesh(X, Y, Z), pos_), hX(X/2), hY(Y/2), hZ(Z/2) {
 }
 
 void cube::build(){
+	addBox(getUniqueMesh(), hX, hY, hZ);
+	boundsChanged = true;
+	shading.invalidate();
+	updateTree();
+}
+
+std::shared_ptr<mesh> cube::getBoxMesh(const double &X, const double &Y, const double &Z){
+	// The cache only holds weak references, so the mesh of a size is freed along with its last cube
+	typedef std::map<std::tuple<double, double, double>, std::weak_ptr<mesh> > boxMap;
+	static boxMap boxes;
+	static std::mutex lock;
+	std::lock_guard<std::mutex> guard(lock);
+	
+	// Drop the entries of freed meshes, so that the cache only grows with the number of sizes in use
+	for(boxMap::iterator iter = boxes.begin(); iter != boxes.end(); ){
+		if(iter->second.expired())
+			iter = boxes.erase(iter);
+		else
+			++iter;
+	}
+	
+	std::weak_ptr<mesh> &entry = boxes[std::make_tuple(X, Y, Z)];
+	std::shared_ptr<mesh> geometry = entry.lock();
+	if(!geometry){
+		geometry = std::make_shared<mesh>();
+		addBox(*geometry, X/2, Y/2, Z/2);
+		entry = geometry;
+	}
+	return geometry;
+}
+
+void cube::addBox(mesh &geometry, const double &halfX, const double &halfY, const double &halfZ){
 	// Add all vertices
-	addVertex(hX, hY, hZ); 
-	addVertex(hX, -hY, hZ); 
-	addVertex(-hX, -hY, hZ);
-	addVertex(-hX, hY, hZ);
-	addVertex(hX, hY, -hZ); 
-	addVertex(hX, -hY, -hZ);
-	addVertex(-hX, -hY, -hZ); 
-	addVertex(-hX, hY, -hZ);
+	unsigned int first = geometry.addVertex(vector3f(halfX, halfY, halfZ));
+	geometry.addVertex(vector3f(halfX, -halfY, halfZ));
+	geometry.addVertex(vector3f(-halfX, -halfY, halfZ));
+	geometry.addVertex(vector3f(-halfX, halfY, halfZ));
+	geometry.addVertex(vector3f(halfX, halfY, -halfZ));
+	geometry.addVertex(vector3f(halfX, -halfY, -halfZ));
+	geometry.addVertex(vector3f(-halfX, -halfY, -halfZ));
+	geometry.addVertex(vector3f(-halfX, halfY, -halfZ));
 
 	// Add all polygons (using clockwise winding)
-	addPolygon(0, 1, 2);
-	addPolygon(2, 3, 0);
-	addPolygon(1, 0, 4);
-	addPolygon(4, 5, 1);
-	addPolygon(5, 4, 7);
-	addPolygon(7, 6, 5);
-	addPolygon(7, 3, 2);
-	addPolygon(2, 6, 7);
-	addPolygon(7, 4, 0);
-	addPolygon(0, 3, 7);
-	addPolygon(6, 2, 1);
-	addPolygon(1, 5, 6);
+	const unsigned int polygons[12][3] = {{0, 1, 2}, {2, 3, 0}, {1, 0, 4}, {4, 5, 1}, {5, 4, 7}, {7, 6, 5},
+	                                      {7, 3, 2}, {2, 6, 7}, {7, 4, 0}, {0, 3, 7}, {6, 2, 1}, {1, 5, 6}};
+	for(int i = 0; i < 12; i++)
+		geometry.addTriangle(first + polygons[i][0], first + polygons[i][1], first + polygons[i][2]);
 }
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cstring>
+
+#include "depthBuffer.hpp"
+
+depthBuffer::depthBuffer(const int &width, const int &height, const depthFormat &fmt/*=FLOAT32*/) : W(0), H(0), format(fmt), scale(1) {
+	setFormat(fmt);
+	resize(width, height);
+}
+
+float depthBuffer::getDepth(const int &x, const int &y) const {
+	size_t index = (size_t)y*W+x;
+	switch(format){
+		case FIXED16:
+			return dataShort[index]/scale;
+		case FIXED24:
+			return dataInt[index]/scale;
+		default:
+			break;
+	}
+	return dataFloat[index];
+}
+
+void depthBuffer::resize(const int &width, const int &height){
+	W = (width > 0 ? width : 0);
+	H = (height > 0 ? height : 0);
+	setFormat(format);
+}
+
+void depthBuffer::setFormat(const depthFormat &fmt){
+	format = fmt;
+
+	// Only allocate storage for the selected format
+	size_t size = (size_t)W*H;
+	std::vector<float>().swap(dataFloat);
+	std::vector<unsigned short>().swap(dataShort);
+	std::vector<unsigned int>().swap(dataInt);
+	switch(format){
+		case FIXED16:
+			scale = 0xFFFF;
+			dataShort.assign(size, 0);
+			break;
+		case FIXED24:
+			scale = 0xFFFFFF;
+			dataInt.assign(size, 0);
+			break;
+		default:
+			scale = 1;
+			dataFloat.assign(size, 0);
+			break;
+	}
+}
+
+void depthBuffer::clear(){
+	// The farthest possible depth is zero for every format, so a bytewise fill will do
+	if(!dataFloat.empty())
+		std::memset(&dataFloat[0], 0, dataFloat.size()*sizeof(float));
+	if(!dataShort.empty())
+		std::memset(&dataShort[0], 0, dataShort.size()*sizeof(unsigned short));
+	if(!dataInt.empty())
+		std::memset(&dataInt[0], 0, dataInt.size()*sizeof(unsigned int));
+}
+
+bool depthBuffer::test(const int &x, const int &y, const float &q, const float &bias/*=0*/) const {
+	if(x < 0 || x >= W || y < 0 || y >= H)
+		return false;
+	return (q*(1+bias) >= getDepth(x, y));
+}
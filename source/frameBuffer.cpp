@@ -0,0 +1,140 @@
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include "frameBuffer.hpp"
+
+frameBuffer::frameBuffer(const int &width, const int &height) : W(0), H(0), drawColor(0xFF000000) {
+	resize(width, height);
+}
+
+void frameBuffer::resize(const int &width, const int &height){
+	W = (width > 0 ? width : 0);
+	H = (height > 0 ? height : 0);
+	pixels.assign((size_t)W*H, drawColor);
+}
+
+void frameBuffer::clear(const sdlColor &color/*=Colors::BLACK*/){
+	if(pixels.empty())
+		return;
+	unsigned int packed = color.toARGB();
+	unsigned char byte = (unsigned char)(packed & 0xFF);
+	if(packed == 0x01010101u*byte) // All four bytes are identical, so a bytewise fill will do
+		std::memset(&pixels[0], byte, pixels.size()*sizeof(unsigned int));
+	else
+		std::fill(pixels.begin(), pixels.end(), packed);
+}
+
+void frameBuffer::drawHorizontalLine(int x1, int x2, const int &y){
+	if(y < 0 || y >= H)
+		return;
+	if(x2 < x1)
+		std::swap(x1, x2);
+	if(x2 < 0 || x1 >= W) // Entire line is off the left or right of the buffer
+		return;
+	if(x1 < 0) x1 = 0;
+	if(x2 >= W) x2 = W-1;
+	std::fill_n(&pixels[(size_t)y*W+x1], x2-x1+1, drawColor);
+}
+
+void frameBuffer::drawLine(const int &x1, const int &y1, const int &x2, const int &y2){
+	if(y1 == y2){ // Fast path for horizontal lines
+		drawHorizontalLine(x1, x2, y1);
+		return;
+	}
+
+	int xA = x1, yA = y1;
+	int xB = x2, yB = y2;
+	if(!clipLine(xA, yA, xB, yB)) // Entire line is off the buffer
+		return;
+
+	// Bresenham's line algorithm
+	int dx = std::abs(xB-xA);
+	int dy = -std::abs(yB-yA);
+	int sx = (xA < xB ? 1 : -1);
+	int sy = (yA < yB ? W : -W);
+	int err = dx + dy;
+	unsigned int *pixel = &pixels[(size_t)yA*W+xA];
+	while(true){
+		*pixel = drawColor;
+		if(xA == xB && yA == yB)
+			break;
+		int err2 = 2*err;
+		if(err2 >= dy){
+			err += dy;
+			xA += (sx > 0 ? 1 : -1);
+			pixel += sx;
+		}
+		if(err2 <= dx){
+			err += dx;
+			yA += (sy > 0 ? 1 : -1);
+			pixel += sy;
+		}
+	}
+}
+
+bool frameBuffer::clipLine(int &x1, int &y1, int &x2, int &y2) const {
+	if(W == 0 || H == 0)
+		return false;
+
+	// Liang-Barsky clipping against the rectangle [0, W-1] x [0, H-1]
+	double dx = x2 - x1;
+	double dy = y2 - y1;
+	double p[4] = {-dx, dx, -dy, dy};
+	double q[4] = {double(x1), double(W-1-x1), double(y1), double(H-1-y1)};
+	double t0 = 0, t1 = 1;
+	for(size_t i = 0; i < 4; i++){
+		if(p[i] == 0){
+			if(q[i] < 0) // Line is parallel to and outside of this edge
+				return false;
+			continue;
+		}
+		double t = q[i]/p[i];
+		if(p[i] < 0){
+			if(t > t1) return false;
+			if(t > t0) t0 = t;
+		}
+		else{
+			if(t < t0) return false;
+			if(t < t1) t1 = t;
+		}
+	}
+
+	int cx1 = x1, cy1 = y1;
+	if(t0 > 0){
+		cx1 = (int)std::floor(x1 + t0*dx + 0.5);
+		cy1 = (int)std::floor(y1 + t0*dy + 0.5);
+	}
+	if(t1 < 1){
+		x2 = (int)std::floor(x1 + t1*dx + 0.5);
+		y2 = (int)std::floor(y1 + t1*dy + 0.5);
+	}
+	x1 = cx1;
+	y1 = cy1;
+
+	// Guard against rounding pushing an endpoint just outside of the buffer
+	x1 = std::min(std::max(x1, 0), W-1); y1 = std::min(std::max(y1, 0), H-1);
+	x2 = std::min(std::max(x2, 0), W-1); y2 = std::min(std::max(y2, 0), H-1);
+
+	return true;
+}
+
+bool frameBuffer::write(const std::string &filename) const {
+	std::ofstream ofile(filename.c_str(), std::ios::binary);
+	if(!ofile.good())
+		return false;
+	ofile << "P6\n" << W << " " << H << "\n255\n";
+	std::vector<unsigned char> row(3*W);
+	for(int y = 0; y < H; y++){
+		const unsigned int *pixel = &pixels[(size_t)y*W];
+		for(int x = 0; x < W; x++){
+			row[3*x]   = (unsigned char)(pixel[x] >> 16);
+			row[3*x+1] = (unsigned char)(pixel[x] >> 8);
+			row[3*x+2] = (unsigned char)(pixel[x]);
+		}
+		ofile.write((const char*)&row[0], row.size());
+	}
+	return ofile.good();
+}
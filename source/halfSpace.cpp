@@ -0,0 +1,138 @@
+#include "halfSpace.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/** @class scalarKernel
+  * @brief Draws 8x8 pixel blocks one pixel at a time
+  */
+
+class scalarKernel{
+public:
+	static const int SIZE = 8;
+
+	template <typename T>
+	static void block(const halfSpaceTriangle &tri, const halfSpaceTarget &target, T *depth, const int &bx, const int &by, int e0, int e1, int e2, float q, const bool &accept){
+		float dqdx = (float)tri.dqdx;
+		float dqdy = (float)tri.dqdy;
+		for(int y = by; y < by+SIZE; y++, e0 += tri.B[0], e1 += tri.B[1], e2 += tri.B[2], q += dqdy){
+			T *depthRow = &depth[(size_t)y*target.width];
+			unsigned int *colorRow = &target.color[(size_t)y*target.width];
+			int ex0 = e0, ex1 = e1, ex2 = e2;
+			float qx = q;
+			for(int x = bx; x < bx+SIZE; x++, ex0 += tri.A[0], ex1 += tri.A[1], ex2 += tri.A[2], qx += dqdx){
+				if(accept || (ex0 | ex1 | ex2) >= 0)
+					halfSpacePixel(depthRow, colorRow, x, qx, target.scale, tri.color);
+			}
+		}
+	}
+};
+
+void fillHalfSpaceScalar(const halfSpaceTriangle &tri, const halfSpaceTarget &target){
+	halfSpaceDispatch<scalarKernel>(tri, target);
+}
+
+#if defined(__SSE2__)
+
+/** @class sse2Kernel
+  * @brief Draws 4x4 pixel blocks using SSE2, one row of four pixels at a time
+  */
+
+class sse2Kernel{
+public:
+	static const int SIZE = 4;
+
+	/** Clamp normalized depths to the range [0, 1]
+	  */
+	static inline __m128 clampDepth(const __m128 &q){
+		return _mm_min_ps(_mm_max_ps(q, _mm_setzero_ps()), _mm_set1_ps(1));
+	}
+
+	/** Depth test four pixels and write the depths which pass
+	  * @return Mask of the pixels which passed the test
+	  */
+	static inline __m128i testDepth(float *row, const __m128 &q, const float &, const __m128i &inside){
+		__m128 stored = _mm_loadu_ps(row);
+		__m128 value = clampDepth(q);
+		__m128 pass = _mm_and_ps(_mm_castsi128_ps(inside), _mm_cmpgt_ps(value, stored));
+		_mm_storeu_ps(row, _mm_or_ps(_mm_and_ps(pass, value), _mm_andnot_ps(pass, stored)));
+		return _mm_castps_si128(pass);
+	}
+
+	static inline __m128i testDepth(unsigned int *row, const __m128 &q, const float &scale, const __m128i &inside){
+		__m128i stored = _mm_loadu_si128((const __m128i*)row);
+		__m128i value = _mm_cvttps_epi32(_mm_mul_ps(clampDepth(q), _mm_set1_ps(scale)));
+		__m128i pass = _mm_and_si128(inside, _mm_cmpgt_epi32(value, stored));
+		_mm_storeu_si128((__m128i*)row, _mm_or_si128(_mm_and_si128(pass, value), _mm_andnot_si128(pass, stored)));
+		return pass;
+	}
+
+	static inline __m128i testDepth(unsigned short *row, const __m128 &q, const float &scale, const __m128i &inside){
+		__m128i stored = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)row), _mm_setzero_si128());
+		__m128i value = _mm_cvttps_epi32(_mm_mul_ps(clampDepth(q), _mm_set1_ps(scale)));
+		__m128i pass = _mm_and_si128(inside, _mm_cmpgt_epi32(value, stored));
+		__m128i result = _mm_or_si128(_mm_and_si128(pass, value), _mm_andnot_si128(pass, stored));
+		
+		// SSE2 has no unsigned 32 to 16-bit pack, so shift into the signed range and back
+		result = _mm_packs_epi32(_mm_sub_epi32(result, _mm_set1_epi32(0x8000)), _mm_setzero_si128());
+		result = _mm_add_epi16(result, _mm_set1_epi16((short)0x8000));
+		_mm_storel_epi64((__m128i*)row, result);
+		return pass;
+	}
+
+	template <typename T>
+	static void block(const halfSpaceTriangle &tri, const halfSpaceTarget &target, T *depth, const int &bx, const int &by, int e0, int e1, int e2, float q, const bool &accept){
+		// Edge function values for the four pixels of the first row
+		__m128i ex0 = _mm_add_epi32(_mm_set1_epi32(e0), _mm_setr_epi32(0, tri.A[0], 2*tri.A[0], 3*tri.A[0]));
+		__m128i ex1 = _mm_add_epi32(_mm_set1_epi32(e1), _mm_setr_epi32(0, tri.A[1], 2*tri.A[1], 3*tri.A[1]));
+		__m128i ex2 = _mm_add_epi32(_mm_set1_epi32(e2), _mm_setr_epi32(0, tri.A[2], 2*tri.A[2], 3*tri.A[2]));
+		__m128i dy0 = _mm_set1_epi32(tri.B[0]);
+		__m128i dy1 = _mm_set1_epi32(tri.B[1]);
+		__m128i dy2 = _mm_set1_epi32(tri.B[2]);
+		
+		// Depths for the four pixels of the first row
+		float dqdx = (float)tri.dqdx;
+		__m128 qx = _mm_add_ps(_mm_set1_ps(q), _mm_setr_ps(0, dqdx, 2*dqdx, 3*dqdx));
+		__m128 dqdy = _mm_set1_ps((float)tri.dqdy);
+
+		__m128i color = _mm_set1_epi32((int)tri.color);
+		__m128i allInside = _mm_set1_epi32(-1);
+		for(int y = by; y < by+SIZE; y++){
+			__m128i inside = (accept ? allInside : _mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(ex0, ex1), ex2), allInside));
+			if(_mm_movemask_epi8(inside)){
+				size_t offset = (size_t)y*target.width + bx;
+				__m128i pass = testDepth(&depth[offset], qx, target.scale, inside);
+				if(_mm_movemask_epi8(pass)){
+					__m128i *colorRow = (__m128i*)&target.color[offset];
+					__m128i stored = _mm_loadu_si128(colorRow);
+					_mm_storeu_si128(colorRow, _mm_or_si128(_mm_and_si128(pass, color), _mm_andnot_si128(pass, stored)));
+				}
+			}
+			ex0 = _mm_add_epi32(ex0, dy0);
+			ex1 = _mm_add_epi32(ex1, dy1);
+			ex2 = _mm_add_epi32(ex2, dy2);
+			qx = _mm_add_ps(qx, dqdy);
+		}
+	}
+};
+
+void fillHalfSpaceSSE2(const halfSpaceTriangle &tri, const halfSpaceTarget &target){
+	halfSpaceDispatch<sse2Kernel>(tri, target);
+}
+
+bool halfSpaceSSE2Compiled(){
+	return true;
+}
+
+#else
+
+void fillHalfSpaceSSE2(const halfSpaceTriangle &tri, const halfSpaceTarget &target){
+	fillHalfSpaceScalar(tri, target);
+}
+
+bool halfSpaceSSE2Compiled(){
+	return false;
+}
+
+#endif
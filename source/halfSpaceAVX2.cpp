@@ -0,0 +1,107 @@
+#include "halfSpace.hpp"
+
+// This file is compiled with AVX2 code generation enabled (when the compiler supports it). 
+//  Nothing in here may be called unless the CPU reports AVX2 support at runtime.
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+/** @class avx2Kernel
+  * @brief Draws 8x8 pixel blocks using AVX2, one row of eight pixels at a time
+  */
+
+class avx2Kernel{
+public:
+	static const int SIZE = 8;
+
+	/** Clamp normalized depths to the range [0, 1]
+	  */
+	static inline __m256 clampDepth(const __m256 &q){
+		return _mm256_min_ps(_mm256_max_ps(q, _mm256_setzero_ps()), _mm256_set1_ps(1));
+	}
+
+	/** Depth test eight pixels and write the depths which pass
+	  * @return Mask of the pixels which passed the test
+	  */
+	static inline __m256i testDepth(float *row, const __m256 &q, const float &, const __m256i &inside){
+		__m256 stored = _mm256_loadu_ps(row);
+		__m256 value = clampDepth(q);
+		__m256 pass = _mm256_and_ps(_mm256_castsi256_ps(inside), _mm256_cmp_ps(value, stored, _CMP_GT_OQ));
+		_mm256_storeu_ps(row, _mm256_blendv_ps(stored, value, pass));
+		return _mm256_castps_si256(pass);
+	}
+
+	static inline __m256i testDepth(unsigned int *row, const __m256 &q, const float &scale, const __m256i &inside){
+		__m256i stored = _mm256_loadu_si256((const __m256i*)row);
+		__m256i value = _mm256_cvttps_epi32(_mm256_mul_ps(clampDepth(q), _mm256_set1_ps(scale)));
+		__m256i pass = _mm256_and_si256(inside, _mm256_cmpgt_epi32(value, stored));
+		_mm256_storeu_si256((__m256i*)row, _mm256_blendv_epi8(stored, value, pass));
+		return pass;
+	}
+
+	static inline __m256i testDepth(unsigned short *row, const __m256 &q, const float &scale, const __m256i &inside){
+		__m256i stored = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)row));
+		__m256i value = _mm256_cvttps_epi32(_mm256_mul_ps(clampDepth(q), _mm256_set1_ps(scale)));
+		__m256i pass = _mm256_and_si256(inside, _mm256_cmpgt_epi32(value, stored));
+		__m256i result = _mm256_blendv_epi8(stored, value, pass);
+		
+		// Pack back down to 16 bits (the pack works within 128-bit lanes, so gather the two halves afterwards)
+		result = _mm256_permute4x64_epi64(_mm256_packus_epi32(result, result), 0x08);
+		_mm_storeu_si128((__m128i*)row, _mm256_castsi256_si128(result));
+		return pass;
+	}
+
+	template <typename T>
+	static void block(const halfSpaceTriangle &tri, const halfSpaceTarget &target, T *depth, const int &bx, const int &by, int e0, int e1, int e2, float q, const bool &accept){
+		// Edge function values for the eight pixels of the first row
+		const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		__m256i ex0 = _mm256_add_epi32(_mm256_set1_epi32(e0), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(tri.A[0])));
+		__m256i ex1 = _mm256_add_epi32(_mm256_set1_epi32(e1), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(tri.A[1])));
+		__m256i ex2 = _mm256_add_epi32(_mm256_set1_epi32(e2), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(tri.A[2])));
+		__m256i dy0 = _mm256_set1_epi32(tri.B[0]);
+		__m256i dy1 = _mm256_set1_epi32(tri.B[1]);
+		__m256i dy2 = _mm256_set1_epi32(tri.B[2]);
+		
+		// Depths for the eight pixels of the first row
+		__m256 qx = _mm256_add_ps(_mm256_set1_ps(q), _mm256_mul_ps(_mm256_cvtepi32_ps(lanes), _mm256_set1_ps((float)tri.dqdx)));
+		__m256 dqdy = _mm256_set1_ps((float)tri.dqdy);
+
+		__m256i color = _mm256_set1_epi32((int)tri.color);
+		__m256i allInside = _mm256_set1_epi32(-1);
+		for(int y = by; y < by+SIZE; y++){
+			__m256i inside = (accept ? allInside : _mm256_cmpgt_epi32(_mm256_or_si256(_mm256_or_si256(ex0, ex1), ex2), allInside));
+			if(!_mm256_testz_si256(inside, inside)){
+				size_t offset = (size_t)y*target.width + bx;
+				__m256i pass = testDepth(&depth[offset], qx, target.scale, inside);
+				if(!_mm256_testz_si256(pass, pass)){
+					__m256i *colorRow = (__m256i*)&target.color[offset];
+					_mm256_storeu_si256(colorRow, _mm256_blendv_epi8(_mm256_loadu_si256(colorRow), color, pass));
+				}
+			}
+			ex0 = _mm256_add_epi32(ex0, dy0);
+			ex1 = _mm256_add_epi32(ex1, dy1);
+			ex2 = _mm256_add_epi32(ex2, dy2);
+			qx = _mm256_add_ps(qx, dqdy);
+		}
+	}
+};
+
+void fillHalfSpaceAVX2(const halfSpaceTriangle &tri, const halfSpaceTarget &target){
+	halfSpaceDispatch<avx2Kernel>(tri, target);
+}
+
+bool halfSpaceAVX2Compiled(){
+	return true;
+}
+
+#else
+
+void fillHalfSpaceAVX2(const halfSpaceTriangle &tri, const halfSpaceTarget &target){
+	fillHalfSpaceScalar(tri, target);
+}
+
+bool halfSpaceAVX2Compiled(){
+	return false;
+}
+
+#endif
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "vector3.hpp"
+#include "camera.hpp"
+#include "cube.hpp"
+#include "scene.hpp"
+#include "offscreenTarget.hpp"
+
+int main(int argc, char *argv[]){
+	// Parse the command line arguments: [frames] [width] [height] [output]
+	int nFrames = (argc > 1 ? std::atoi(argv[1]) : 1000);
+	int width = (argc > 2 ? std::atoi(argv[2]) : 640);
+	int height = (argc > 3 ? std::atoi(argv[3]) : 480);
+	std::string output = (argc > 4 ? argv[4] : "headless.ppm");
+
+	// Define a new cube
+	cube myCube(vector3(), 1, 1, 1);
+	myCube.setDrawingMode(scene::RENDER);
+	
+	// Setup the camera at z=-1.5 m (facing the cube)
+	camera cam(vector3(0, 0, -1.5));
+	
+	// Render into memory instead of a window
+	offscreenTarget target(width, height);
+	
+	// Setup the scene with our camera
+	scene myScene(&cam, &target);
+	myScene.setFramerateCap(0); // Render as fast as possible
+	myScene.addObject(&myCube);
+	
+	// Rotate the cube for a fixed number of frames
+	for(int i = 0; i < nFrames; i++){
+		myCube.rotate(0.24*deg2rad, 0.14*deg2rad, 0.34*deg2rad);
+		myScene.update();
+	}
+	
+	std::cout << " Rendered " << target.getFrameCount() << " frames (" << width << "x" << height << ")\n";
+	std::cout << " Average render time: " << myScene.getAverageRenderTime()*1E3 << " ms (" << 1/myScene.getAverageRenderTime() << " fps)\n";
+
+	// Write the final frame to disk
+	if(!output.empty() && target.write(output))
+		std::cout << " Wrote final frame to \"" << output << "\"\n";
+	
+	return 0;
+}
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <cmath>
 
 #include "lightSource.hpp"
 #include "plane.hpp"
+#include "camera.hpp"
 
 float lightSource::getIntensity(const plane *surface) const {
 	// Compute the dot-product between the triangle normal and the light direction
@@ -12,21 +14,107 @@ float lightSource::getIntensity(const plane *surface) const {
 	return (dp > 0 ? brightness*dp : 0);
 }
 
+faceLight lightSource::getFaceLight(const vector3 &offset, const matrix3 &rotation) const {
+	faceLight light;
+	vector3 direction = dir;
+	rotation.transpose(direction);
+	light.type = faceLight::DIRECTIONAL;
+	light.direction = vector3f(direction);
+	light.color = linearColor(color)*brightness;
+	return light;
+}
+
+bool directionalLight::getShadowCamera(camera &cam, const vector3 &sceneMin, const vector3 &sceneMax) const {
+	vector3 center = (sceneMin + sceneMax)*0.5;
+	double radius = (sceneMax - sceneMin).length()/2;
+	if(radius <= 0 || dir.square() == 0)
+		return false;
+	
+	// Fit the field-of-view to the sphere around the scene
+	double distance = DIRECTIONAL_SHADOW_DISTANCE*radius;
+	cam.moveTo(center - dir.normalize()*distance);
+	cam.lookAt(center);
+	cam.setAspectRatio(1);
+	cam.setFOV(2*std::asin(radius/distance)*rad2deg);
+	cam.setViewDistance(distance + radius);
+	return true;
+}
+
 float pointLight::getIntensity(const plane *surface) const {
-	float dp = -(dir * surface->norm);
+	vector3 displacement = (surface->p - pos);
+	float dist = displacement.length();
+	if(dist > range)
+		return 0;
+	float dp = -(displacement * surface->norm)/dist;
 	if(dp < 0) 
 		return 0;
-	return dp/(surface->p - pos).length();
+	return brightness*dp/dist;
+}
+
+bool pointLight::illuminates(const vector3 &center, const double &radius) const {
+	return ((center - pos).length() - radius <= range);
+}
+
+faceLight pointLight::getFaceLight(const vector3 &offset, const matrix3 &rotation) const {
+	faceLight light = lightSource::getFaceLight(offset, rotation);
+	vector3 position = pos - offset;
+	rotation.transpose(position);
+	light.type = faceLight::POINT;
+	light.position = vector3f(position);
+	light.rangeSquare = range*range;
+	return light;
 }
 
 float coneLight::getIntensity(const plane *surface) const {
-	float dp = -(dir * surface->norm);
-	if(dp < 0) 
-		return 0;
 	vector3 displacement = (surface->p - pos);
 	float dist = displacement.length();
-	float beta = std::acos((displacement * dir)/dist);
-	if(beta > openingAngle/2)
+	if(dist > range)
+		return 0;
+	float dp = -(displacement * surface->norm)/dist;
+	if(dp < 0) 
+		return 0;
+	
+	// Compare cosines rather than angles, since the cosine decreases with the angle
+	if((displacement * dir)/dist < std::cos(openingAngle/2))
 		return 0;
-	return (dp / dist);
+	return brightness*dp/dist;
+}
+
+bool coneLight::illuminates(const vector3 &center, const double &radius) const {
+	vector3 displacement = (center - pos);
+	if(displacement.length() - radius > range) // Sphere is out of range
+		return false;
+	
+	// Distance from the center of the sphere to the surface of the cone, measured perpendicular to the surface. This
+	//  underestimates the distance to spheres behind the tip of the cone, so the test errs on the side of lighting
+	double halfAngle = openingAngle/2;
+	double along = displacement * dir;
+	double across = std::sqrt(std::max(0.0, displacement.square() - along*along));
+	return (across*std::cos(halfAngle) - along*std::sin(halfAngle) <= radius);
+}
+
+faceLight coneLight::getFaceLight(const vector3 &offset, const matrix3 &rotation) const {
+	faceLight light = lightSource::getFaceLight(offset, rotation);
+	vector3 position = pos - offset;
+	rotation.transpose(position);
+	light.type = faceLight::CONE;
+	light.position = vector3f(position);
+	light.rangeSquare = range*range;
+	light.cosHalfAngle = std::cos(openingAngle/2);
+	return light;
+}
+
+bool coneLight::getShadowCamera(camera &cam, const vector3 &sceneMin, const vector3 &sceneMax) const {
+	if(openingAngle >= pi || dir.square() == 0)
+		return false;
+	
+	// Nothing beyond the range of the light, or beyond the far side of the scene, needs to be drawn
+	vector3 center = (sceneMin + sceneMax)*0.5;
+	double farthest = (center - pos).length() + (sceneMax - sceneMin).length()/2;
+	cam.moveTo(pos);
+	cam.lookAt(pos + dir);
+	cam.setAspectRatio(1);
+	cam.setFOV(openingAngle*rad2deg);
+	cam.setViewDistance(std::min(farthest, (double)range));
+	return true;
 }
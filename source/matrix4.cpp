@@ -0,0 +1,70 @@
+#include <iomanip>
+#include <sstream>
+
+#include "matrix4.hpp"
+
+matrix4::matrix4(){
+	zero();
+}
+
+matrix4::matrix4(const double &a00, const double &a01, const double &a02, const double &a03,
+                 const double &a10, const double &a11, const double &a12, const double &a13,
+                 const double &a20, const double &a21, const double &a22, const double &a23,
+                 const double &a30, const double &a31, const double &a32, const double &a33){
+	setRow(0, a00, a01, a02, a03);
+	setRow(1, a10, a11, a12, a13);
+	setRow(2, a20, a21, a22, a23);
+	setRow(3, a30, a31, a32, a33);
+}
+
+matrix4 matrix4::operator * (const matrix4 &rhs) const {
+	matrix4 retval;
+	for(unsigned int i = 0; i < 4; i++){ // Over rows
+		for(unsigned int j = 0; j < 4; j++){ // Over columns
+			for(unsigned int k = 0; k < 4; k++){
+				retval.elements[i][j] += elements[i][k]*rhs.elements[k][j];
+			}
+		}
+	}
+	return retval;
+}
+
+matrix4& matrix4::operator *= (const matrix4 &rhs){
+	(*this) = (*this)*rhs;
+	return (*this);
+}
+
+void matrix4::setRow(const size_t &row, const double &p0, const double &p1, const double &p2, const double &p3){
+	elements[row][0] = p0; elements[row][1] = p1; elements[row][2] = p2; elements[row][3] = p3;
+}
+
+std::string matrix4::dump() const {
+	std::stringstream stream;
+	stream.precision(3);
+	stream << std::fixed;
+	for(size_t i = 0; i < 4; i++)
+		stream << "[" << std::setw(8) << elements[i][0] << ", " << std::setw(8) << elements[i][1] << ", " << std::setw(8) << elements[i][2] << ", " << std::setw(8) << elements[i][3] << "]\n";
+	return stream.str();
+}
+
+matrix4 matrix4::getTransformMatrix(const matrix3 &rot, const vector3 &offset){
+	return matrix4(rot.elements[0][0], rot.elements[0][1], rot.elements[0][2], offset.x,
+	               rot.elements[1][0], rot.elements[1][1], rot.elements[1][2], offset.y,
+	               rot.elements[2][0], rot.elements[2][1], rot.elements[2][2], offset.z,
+	                                0,                  0,                  0,        1);
+}
+
+void matrix4::zero(){
+	for(size_t i = 0; i < 4; i++){
+		for(size_t j = 0; j < 4; j++){
+			elements[i][j] = 0.0;
+		}
+	}
+}
+
+void matrix4::identity(){
+	zero(); // Start by zeroing the matrix
+	for(size_t i = 0; i < 4; i++){
+		elements[i][i] = 1.0; // Set the diagonal elements to 1
+	}
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cmath>
+
+#include "mesh.hpp"
+#include "triangle.hpp"
+#include "meshSimplifier.hpp"
+
+const size_t mesh::MESHLET_SIZE;
+const size_t mesh::MIN_LOD_TRIANGLES;
+
+const double CONE_TOLERANCE = 1E-5; ///< Relative margin by which a meshlet must face away before it is rejected, covering rounding in the per-triangle test
+
+bool meshlet::isBackfacing(const vector3 &point) const {
+	if(cosAngle <= 0) // The normals are spread over more than a hemisphere
+		return false;
+	
+	// Every normal lies within the half-angle of the cone axis, so the angle between a normal and the direction from
+	//  the point to the sphere center is at most the angle between that direction and the axis plus the half-angle.
+	//  The cluster faces away if the projection of that direction onto every normal exceeds the radius of the sphere
+	vector3 dir = center - point;
+	double along = dir*axis;
+	double across = std::sqrt(std::max(0.0, dir.square() - along*along));
+	double margin = CONE_TOLERANCE*(dir.length() + center.length() + radius);
+	return (along*cosAngle - across*sinAngle > radius + margin);
+}
+
+size_t mesh::getMemoryUsage() const {
+	return (3*sizeof(float)*(vertices.size() + normals.size() + centroids.size()) + indices.getIndexSize()*indices.size());
+}
+
+void mesh::reserve(const size_t &nVertices, const size_t &nTriangles){
+	vertices.reserve(nVertices);
+	indices.reserve(3*nTriangles, (nVertices > 0 ? (unsigned int)(nVertices-1) : 0));
+	normals.reserve(nTriangles);
+	centroids.reserve(nTriangles);
+}
+
+unsigned int mesh::addVertex(const vector3f &vertex){
+	vertices.push_back(vertex);
+	
+	// Grow the bounding box to contain the new vertex. The sphere is recomputed the next time it is needed
+	vector3 vert(vertex);
+	if(vertices.size() == 1){
+		boxMin = vert;
+		boxMax = vert;
+	}
+	else{
+		boxMin = vector3(std::min(boxMin.x, vert.x), std::min(boxMin.y, vert.y), std::min(boxMin.z, vert.z));
+		boxMax = vector3(std::max(boxMax.x, vert.x), std::max(boxMax.y, vert.y), std::max(boxMax.z, vert.z));
+	}
+	sphereChanged = true;
+	
+	return (unsigned int)(vertices.size()-1);
+}
+
+void mesh::addTriangle(const unsigned int &i0, const unsigned int &i1, const unsigned int &i2){
+	indices.push_back(i0);
+	indices.push_back(i1);
+	indices.push_back(i2);
+	
+	// Compute the face in double precision, then store it alongside the vertices in single precision
+	triangle face(vector3(vertices.get(i0)), vector3(vertices.get(i1)), vector3(vertices.get(i2)));
+	normals.push_back(vector3f(face.norm));
+	centroids.push_back(vector3f(face.p));
+	meshletsChanged = true;
+	
+	// Any existing levels of detail no longer match the mesh
+	if(!levels.empty()){
+		levels.clear();
+		levelErrors.clear();
+	}
+	levelsChanged = true;
+}
+
+void mesh::clear(){
+	vertices.clear();
+	indices.clear();
+	normals.clear();
+	centroids.clear();
+	boxMin = vector3();
+	boxMax = vector3();
+	sphereCenter = vector3();
+	sphereRadius = 0;
+	sphereChanged = false;
+	meshlets.clear();
+	meshletsChanged = false;
+	levels.clear();
+	levelErrors.clear();
+	levelsChanged = false;
+}
+
+void mesh::buildLevelsOfDetail() const {
+	if(!levelsChanged)
+		return;
+	levelsChanged = false;
+	
+	// Run a single progressive simplification pass over the full mesh and take a copy of the result each time the
+	//  number of triangles is halved. Each level continues from the last, but its error is always measured against
+	//  the full mesh, so the error of a coarse level includes that of the finer ones
+	const size_t nTriangles = getNumberOfTriangles();
+	if(nTriangles/2 < MIN_LOD_TRIANGLES)
+		return;
+	meshSimplifier simplifier(*this);
+	size_t previous = nTriangles;
+	for(size_t target = nTriangles/2; target >= MIN_LOD_TRIANGLES; target = previous/2){
+		bool reached = simplifier.simplify(target);
+		if(4*simplifier.getNumberOfTriangles() > 3*previous) // Not worth another level
+			break;
+		std::shared_ptr<mesh> level = std::make_shared<mesh>();
+		simplifier.getMesh(*level);
+		levels.push_back(level);
+		levelErrors.push_back(simplifier.getError());
+		previous = simplifier.getNumberOfTriangles();
+		if(!reached) // No more edges can be collapsed
+			break;
+	}
+}
+
+void mesh::updateSphere() const {
+	vector3f center((boxMin + boxMax)*0.5);
+	sphereCenter = vector3(center);
+	sphereRadius = std::sqrt((double)vertices.getMaxSquareDistance(center));
+	sphereChanged = false;
+}
+
+void mesh::buildMeshlets() const {
+	const size_t nTriangles = getNumberOfTriangles();
+	meshlets.clear();
+	meshlets.reserve((nTriangles + MESHLET_SIZE - 1)/MESHLET_SIZE);
+	
+	// Split the triangles into runs of consecutive triangles. This keeps the order in which triangles are drawn
+	//  and relies on the mesh being built in a spatially coherent order
+	for(size_t first = 0; first < nTriangles; first += MESHLET_SIZE){
+		meshlet cluster;
+		cluster.first = first;
+		cluster.count = std::min(MESHLET_SIZE, nTriangles - first);
+		
+		// Bounding sphere centered on the bounding box of the vertices
+		unsigned int tri[3];
+		vector3 boxMin(vertices.get(indices[3*first]));
+		vector3 boxMax(boxMin);
+		for(size_t i = first; i < first + cluster.count; i++){
+			getTriangle(i, tri);
+			for(size_t j = 0; j < 3; j++){
+				vector3 vert(vertices.get(tri[j]));
+				boxMin = vector3(std::min(boxMin.x, vert.x), std::min(boxMin.y, vert.y), std::min(boxMin.z, vert.z));
+				boxMax = vector3(std::max(boxMax.x, vert.x), std::max(boxMax.y, vert.y), std::max(boxMax.z, vert.z));
+			}
+		}
+		cluster.center = (boxMin + boxMax)*0.5;
+		double maxSquare = 0;
+		for(size_t i = first; i < first + cluster.count; i++){
+			getTriangle(i, tri);
+			for(size_t j = 0; j < 3; j++)
+				maxSquare = std::max(maxSquare, (vector3(vertices.get(tri[j])) - cluster.center).square());
+		}
+		cluster.radius = std::sqrt(maxSquare);
+		
+		// Normal cone around the average normal, just wide enough to contain every normal
+		vector3 sum;
+		for(size_t i = first; i < first + cluster.count; i++)
+			sum += vector3(normals.get(i));
+		if(sum.square() > 0){
+			cluster.axis = sum.normalize();
+			cluster.cosAngle = 1;
+			for(size_t i = first; i < first + cluster.count; i++)
+				cluster.cosAngle = std::min(cluster.cosAngle, vector3(normals.get(i)).normalize()*cluster.axis);
+			cluster.sinAngle = std::sqrt(std::max(0.0, 1 - cluster.cosAngle*cluster.cosAngle));
+		}
+		
+		meshlets.push_back(cluster);
+	}
+	meshletsChanged = false;
+}
@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <cmath>
+
+#include "meshSimplifier.hpp"
+#include "mesh.hpp"
+
+const double BOUNDARY_WEIGHT = 1000; ///< Weight of the planes which hold open boundaries in place, relative to the surface planes
+
+const double MIN_NORMAL_COSINE = 0.2; ///< Smallest cosine of the angle by which a collapse may turn the normal of a triangle
+
+const double SINGULAR_TOLERANCE = 1E-10; ///< Relative size of the determinant below which a quadric is considered to have no unique minimum
+
+quadric::quadric(){
+	std::fill(a, a+10, 0.0);
+}
+
+quadric::quadric(const vector3 &norm, const vector3 &point, const double &weight/*=1*/){
+	// Plane n*x + d = 0, the matrix is weight*(n, d)^T*(n, d)
+	double d = -(norm*point);
+	a[0] = weight*norm.x*norm.x; a[1] = weight*norm.x*norm.y; a[2] = weight*norm.x*norm.z; a[3] = weight*norm.x*d;
+	a[4] = weight*norm.y*norm.y; a[5] = weight*norm.y*norm.z; a[6] = weight*norm.y*d;
+	a[7] = weight*norm.z*norm.z; a[8] = weight*norm.z*d;
+	a[9] = weight*d*d;
+}
+
+quadric& quadric::operator += (const quadric &rhs){
+	for(size_t i = 0; i < 10; i++)
+		a[i] += rhs.a[i];
+	return (*this);
+}
+
+double quadric::evaluate(const vector3 &p) const {
+	return (a[0]*p.x*p.x + 2*a[1]*p.x*p.y + 2*a[2]*p.x*p.z + 2*a[3]*p.x +
+	        a[4]*p.y*p.y + 2*a[5]*p.y*p.z + 2*a[6]*p.y +
+	        a[7]*p.z*p.z + 2*a[8]*p.z + a[9]);
+}
+
+bool quadric::minimize(vector3 &p) const {
+	// Solve the 3x3 system A*p = -b using Cramer's rule
+	double c00 = a[4]*a[7] - a[5]*a[5];
+	double c01 = a[2]*a[5] - a[1]*a[7];
+	double c02 = a[1]*a[5] - a[2]*a[4];
+	double det = a[0]*c00 + a[1]*c01 + a[2]*c02;
+	double trace = a[0] + a[4] + a[7];
+	if(std::fabs(det) <= SINGULAR_TOLERANCE*trace*trace*trace)
+		return false;
+	double c11 = a[0]*a[7] - a[2]*a[2];
+	double c12 = a[1]*a[2] - a[0]*a[5];
+	double c22 = a[0]*a[4] - a[1]*a[1];
+	p.x = -(c00*a[3] + c01*a[6] + c02*a[8])/det;
+	p.y = -(c01*a[3] + c11*a[6] + c12*a[8])/det;
+	p.z = -(c02*a[3] + c12*a[6] + c22*a[8])/det;
+	return true;
+}
+
+/** Get a key which is unique to the edge between two vertices, regardless of their order
+  */
+static unsigned long long edgeKey(const unsigned int &v0, const unsigned int &v1){
+	return (v0 < v1 ? ((unsigned long long)v0 << 32 | v1) : ((unsigned long long)v1 << 32 | v0));
+}
+
+meshSimplifier::meshSimplifier(const mesh &input) : liveTriangles(input.getNumberOfTriangles()) {
+	const vertexArray *vertices = input.getVertices();
+	const size_t nVertices = input.getNumberOfVertices();
+	positions.reserve(nVertices);
+	for(size_t i = 0; i < nVertices; i++)
+		positions.push_back(vector3(vertices->get(i)));
+	inputPositions = positions;
+	quadrics.assign(nVertices, quadric());
+	stamps.assign(nVertices, 0);
+	removed.assign(nVertices, false);
+	parents.resize(nVertices);
+	for(size_t i = 0; i < nVertices; i++)
+		parents[i] = (unsigned int)i;
+
+	triangles.resize(3*liveTriangles);
+	alive.assign(liveTriangles, true);
+	vertexTriangles.resize(nVertices);
+	for(size_t i = 0; i < liveTriangles; i++){
+		input.getTriangle(i, &triangles[3*i]);
+		for(size_t j = 0; j < 3; j++)
+			vertexTriangles[triangles[3*i+j]].push_back((unsigned int)i);
+	}
+
+	// Every vertex starts with the planes of the triangles around it, weighted by their areas. Count how many
+	//  triangles use each edge
+	std::unordered_map<unsigned long long, unsigned int> edges;
+	std::vector<vector3> faceNormals(liveTriangles);
+	for(size_t i = 0; i < liveTriangles; i++){
+		const unsigned int *tri = &triangles[3*i];
+		vector3 norm = (positions[tri[1]] - positions[tri[0]]).cross(positions[tri[2]] - positions[tri[0]]);
+		double len = norm.length();
+		if(len > 0){ // Degenerate triangles have no plane
+			faceNormals[i] = norm/len;
+			quadric plane(faceNormals[i], positions[tri[0]], len/2);
+			for(size_t j = 0; j < 3; j++)
+				quadrics[tri[j]] += plane;
+		}
+		for(size_t j = 0; j < 3; j++)
+			edges[edgeKey(tri[j], tri[(j+1)%3])]++;
+	}
+
+	// Edges used by a single triangle lie on an open boundary. Hold them in place with a plane which contains the
+	//  edge and is perpendicular to the triangle, so that the outline of the mesh is not eroded
+	for(size_t i = 0; i < liveTriangles; i++){
+		const unsigned int *tri = &triangles[3*i];
+		for(size_t j = 0; j < 3; j++){
+			unsigned int v0 = tri[j], v1 = tri[(j+1)%3];
+			if(edges[edgeKey(v0, v1)] != 1)
+				continue;
+			vector3 norm = (positions[v1] - positions[v0]).cross(faceNormals[i]);
+			double len = norm.length();
+			if(len == 0)
+				continue;
+			quadric plane(norm/len, positions[v0], BOUNDARY_WEIGHT*len*len); // Scaled by the squared edge length to match the area weights
+			quadrics[v0] += plane;
+			quadrics[v1] += plane;
+		}
+	}
+
+	for(std::unordered_map<unsigned long long, unsigned int>::const_iterator edge = edges.begin(); edge != edges.end(); edge++)
+		addCandidate((unsigned int)(edge->first >> 32), (unsigned int)(edge->first & 0xFFFFFFFF));
+}
+
+double meshSimplifier::getError() const {
+	double maxDist = 0;
+	for(size_t i = 0; i < inputPositions.size(); i++){
+		unsigned int vertex = (unsigned int)i;
+		while(parents[vertex] != vertex) // Follow the collapses to the remaining vertex
+			vertex = parents[vertex];
+		if(vertex == i && positions[i] == inputPositions[i]) // Never moved
+			continue;
+		double minDist = -1;
+		const std::vector<unsigned int> &around = vertexTriangles[vertex];
+		for(std::vector<unsigned int>::const_iterator index = around.begin(); index != around.end(); index++){
+			if(!alive[*index])
+				continue;
+			const unsigned int *tri = &triangles[3*(*index)];
+			vector3 norm = (positions[tri[1]] - positions[tri[0]]).cross(positions[tri[2]] - positions[tri[0]]);
+			double len = norm.length();
+			if(len == 0)
+				continue;
+			double dist = std::fabs(norm*(inputPositions[i] - positions[tri[0]]))/len;
+			if(minDist < 0 || dist < minDist)
+				minDist = dist;
+		}
+		maxDist = std::max(maxDist, minDist);
+	}
+	return maxDist;
+}
+
+bool meshSimplifier::simplify(const size_t &targetTriangles){
+	while(liveTriangles > targetTriangles){
+		if(candidates.empty())
+			return false;
+		collapse edge = candidates.top();
+		candidates.pop();
+		apply(edge);
+	}
+	return true;
+}
+
+void meshSimplifier::getMesh(mesh &output) const {
+	// Number the remaining vertices in the order in which the remaining triangles first use them
+	const unsigned int unused = 0xFFFFFFFF;
+	std::vector<unsigned int> remap(positions.size(), unused);
+	unsigned int nVertices = 0;
+	for(size_t i = 0; i < alive.size(); i++){
+		if(!alive[i])
+			continue;
+		for(size_t j = 0; j < 3; j++){
+			if(remap[triangles[3*i+j]] == unused)
+				remap[triangles[3*i+j]] = nVertices++;
+		}
+	}
+
+	output.clear();
+	output.reserve(nVertices, liveTriangles);
+	std::vector<unsigned int> order(nVertices);
+	for(size_t i = 0; i < positions.size(); i++){
+		if(remap[i] != unused)
+			order[remap[i]] = (unsigned int)i;
+	}
+	for(size_t i = 0; i < order.size(); i++)
+		output.addVertex(vector3f(positions[order[i]]));
+	for(size_t i = 0; i < alive.size(); i++){
+		if(alive[i])
+			output.addTriangle(remap[triangles[3*i]], remap[triangles[3*i+1]], remap[triangles[3*i+2]]);
+	}
+}
+
+void meshSimplifier::addCandidate(const unsigned int &v0, const unsigned int &v1){
+	collapse edge;
+	edge.v0 = v0;
+	edge.v1 = v1;
+	edge.stamp0 = stamps[v0];
+	edge.stamp1 = stamps[v1];
+
+	// Move the kept vertex to the point of least error. If there is no unique minimum, or if it lies far from the
+	//  edge because the planes are close to parallel, use the best of the two ends of the edge and its midpoint
+	quadric sum = quadrics[v0];
+	sum += quadrics[v1];
+	vector3 midpoint = (positions[v0] + positions[v1])*0.5;
+	if(!sum.minimize(edge.target) || (edge.target - midpoint).square() > (positions[v1] - positions[v0]).square()){
+		const vector3 choices[3] = {positions[v0], positions[v1], midpoint};
+		edge.target = choices[0];
+		for(size_t i = 1; i < 3; i++){
+			if(sum.evaluate(choices[i]) < sum.evaluate(edge.target))
+				edge.target = choices[i];
+		}
+	}
+	edge.cost = std::max(0.0, sum.evaluate(edge.target));
+	candidates.push(edge);
+}
+
+bool meshSimplifier::flipsTriangles(const unsigned int &vertex, const unsigned int &other, const vector3 &target) const {
+	const std::vector<unsigned int> &around = vertexTriangles[vertex];
+	for(std::vector<unsigned int>::const_iterator index = around.begin(); index != around.end(); index++){
+		if(!alive[*index])
+			continue;
+		const unsigned int *tri = &triangles[3*(*index)];
+		if(tri[0] == other || tri[1] == other || tri[2] == other) // Triangle is removed by the collapse
+			continue;
+		vector3 before[3], after[3];
+		for(size_t j = 0; j < 3; j++){
+			before[j] = positions[tri[j]];
+			after[j] = (tri[j] == vertex ? target : before[j]);
+		}
+		vector3 oldNorm = (before[1] - before[0]).cross(before[2] - before[0]);
+		vector3 newNorm = (after[1] - after[0]).cross(after[2] - after[0]);
+		if(oldNorm.square() == 0) // Degenerate triangles have no orientation to preserve
+			continue;
+		if(newNorm*oldNorm <= MIN_NORMAL_COSINE*newNorm.length()*oldNorm.length())
+			return true;
+	}
+	return false;
+}
+
+bool meshSimplifier::apply(const collapse &edge){
+	const unsigned int v0 = edge.v0, v1 = edge.v1;
+	if(removed[v0] || removed[v1] || stamps[v0] != edge.stamp0 || stamps[v1] != edge.stamp1) // Out of date
+		return false;
+
+	// Both vertices must share only the vertices opposite the edge, otherwise the collapse pinches the surface
+	std::vector<unsigned int> neighbors0, neighbors1, opposite;
+	for(size_t pass = 0; pass < 2; pass++){
+		const unsigned int vertex = (pass == 0 ? v0 : v1);
+		std::vector<unsigned int> &neighbors = (pass == 0 ? neighbors0 : neighbors1);
+		for(std::vector<unsigned int>::const_iterator index = vertexTriangles[vertex].begin(); index != vertexTriangles[vertex].end(); index++){
+			if(!alive[*index])
+				continue;
+			const unsigned int *tri = &triangles[3*(*index)];
+			bool onEdge = (tri[0] == v0 || tri[1] == v0 || tri[2] == v0) && (tri[0] == v1 || tri[1] == v1 || tri[2] == v1);
+			for(size_t j = 0; j < 3; j++){
+				if(tri[j] == v0 || tri[j] == v1)
+					continue;
+				neighbors.push_back(tri[j]);
+				if(pass == 0 && onEdge)
+					opposite.push_back(tri[j]);
+			}
+		}
+		std::sort(neighbors.begin(), neighbors.end());
+		neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+	}
+	std::vector<unsigned int> shared;
+	std::set_intersection(neighbors0.begin(), neighbors0.end(), neighbors1.begin(), neighbors1.end(), std::back_inserter(shared));
+	if(shared.size() != opposite.size())
+		return false;
+
+	if(flipsTriangles(v0, v1, edge.target) || flipsTriangles(v1, v0, edge.target))
+		return false;
+
+	// Move the kept vertex and give it the triangles of the removed vertex. Triangles which used both are removed
+	positions[v0] = edge.target;
+	quadrics[v0] += quadrics[v1];
+	removed[v1] = true;
+	parents[v1] = v0;
+	stamps[v0]++;
+	for(std::vector<unsigned int>::const_iterator index = vertexTriangles[v1].begin(); index != vertexTriangles[v1].end(); index++){
+		if(!alive[*index])
+			continue;
+		unsigned int *tri = &triangles[3*(*index)];
+		if(tri[0] == v0 || tri[1] == v0 || tri[2] == v0){
+			alive[*index] = false;
+			liveTriangles--;
+			continue;
+		}
+		for(size_t j = 0; j < 3; j++){
+			if(tri[j] == v1)
+				tri[j] = v0;
+		}
+		vertexTriangles[v0].push_back(*index);
+	}
+	std::vector<unsigned int>().swap(vertexTriangles[v1]);
+	std::vector<unsigned int> &around = vertexTriangles[v0];
+	around.erase(std::remove_if(around.begin(), around.end(), [this](const unsigned int &index){ return !alive[index]; }), around.end());
+
+	// The costs of all edges of the kept vertex have changed
+	std::vector<unsigned int> neighbors;
+	neighbors.swap(neighbors0);
+	neighbors.insert(neighbors.end(), neighbors1.begin(), neighbors1.end());
+	std::sort(neighbors.begin(), neighbors.end());
+	neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+	for(std::vector<unsigned int>::const_iterator vertex = neighbors.begin(); vertex != neighbors.end(); vertex++)
+		addCandidate(v0, *vertex);
+
+	return true;
+}
@@ -1,53 +1,165 @@
+#include <algorithm>
+#include <cmath>
+
 #include "object.hpp"
+#include "ray.hpp"
+#include "bvh.hpp"
 
-void object::rotate(const double &theta, const double &phi, const double &psi){
-	rot.setRotation(theta, phi, psi);
+object::object(const object &other) : pos(other.pos), pos0(other.pos0), orient(other.orient), rot(identityMatrix), rotChanged(true), dmode(other.dmode), color(other.color), geometry(other.geometry), sphereCenter(), boxMin(), boxMax(), boundsChanged(true), tree(NULL), treeNode(-1) { }
+
+object::~object(){
+	if(tree)
+		tree->remove(this);
+}
+
+object& object::operator = (const object &rhs){
+	if(&rhs == this)
+		return *this;
+	pos = rhs.pos;
+	pos0 = rhs.pos0;
+	orient = rhs.orient;
+	rotChanged = true;
+	dmode = rhs.dmode;
+	color = rhs.color;
+	geometry = rhs.geometry;
+	boundsChanged = true;
+	shading.invalidate();
+	updateTree();
+	return *this;
+}
+
+bool object::intersects(const ray &r, double &t) const {
+	// Move the ray into the object's reference frame. The rotation preserves lengths, so t is unchanged
+	vector3 origin = r.pos - pos;
+	vector3 dir = r.dir;
+	const matrix3 &rotation = getRotation();
+	rotation.transpose(origin);
+	rotation.transpose(dir);
 	
-	// Update the rotation of all vertices
+	// Moller-Trumbore intersection test against each polygon (from either side)
+	bool found = false;
+	const vertexArray *vertices = geometry->getVertices();
+	unsigned int tri[3];
+	for(size_t i = 0; i < geometry->getNumberOfTriangles(); i++){
+		geometry->getTriangle(i, tri);
+		vector3 p0(vertices->get(tri[0]));
+		vector3 edge1 = vector3(vertices->get(tri[1])) - p0;
+		vector3 edge2 = vector3(vertices->get(tri[2])) - p0;
+		vector3 pvec = dir.cross(edge2);
+		double det = edge1 * pvec;
+		if(det == 0) // Ray is parallel to the polygon
+			continue;
+		double invDet = 1/det;
+		vector3 tvec = origin - p0;
+		double u = (tvec * pvec)*invDet;
+		if(u < 0 || u > 1)
+			continue;
+		vector3 qvec = tvec.cross(edge1);
+		double v = (dir * qvec)*invDet;
+		if(v < 0 || u + v > 1)
+			continue;
+		double dist = (edge2 * qvec)*invDet;
+		if(dist >= 0 && (!found || dist < t)){
+			t = dist;
+			found = true;
+		}
+	}
+	return found;
+}
+
+void object::rotate(const double &theta, const double &phi, const double &psi){
+	rotate(quaternion(theta, phi, psi));
+}
+
+void object::rotate(const quaternion &rotation){
+	// Re-normalize so that accumulating many small rotations does not skew the object
+	orient = rotation*orient;
+	orient.normInPlace();
 	transform();
 }
 
 void object::move(const vector3 &offset){
 	pos += offset;
+	shading.invalidate(); // Positional lights reach the object from a different direction
+	updateTree();
 }
 
 void object::setRotation(const double &theta, const double &phi, const double &psi){
-	rot.setRotation(theta, phi, psi);
+	orient.setRotation(theta, phi, psi);
+	transform();
+}
 
-	// Reset all vertices to their original position
-	resetVertices();
-	
-	// Update the rotation of all vertices
+void object::setRotation(const quaternion &orientation){
+	orient = orientation.normalize();
 	transform();
 }
 
 void object::setPosition(const vector3 &position){
 	pos = position;
+	shading.invalidate();
+	updateTree();
 }
 
 void object::resetVertices(){
-	vertices = vertices0;
+	orient.identity();
+	transform();
 }
 
 void object::resetPosition(){
 	pos = pos0;
+	shading.invalidate();
+	updateTree();
 }
 
 void object::transform(){
-	// Transform all object vertices
-	for(std::vector<vector3>::iterator vert = vertices.begin(); vert != vertices.end(); vert++)
-		rot.transform((*vert));
+	// The rotation matrix, the bounding volumes, and the shaded colors are recomputed the next time they are needed
+	rotChanged = true;
+	boundsChanged = true;
+	shading.invalidate();
+	updateTree();
+}
+
+void object::updateBounds() const {
+	if(!boundsChanged)
+		return;
+	const matrix3 &rotation = getRotation();
+	const vector3 &localMin = geometry->getBoundingBoxMin();
+	const vector3 &localMax = geometry->getBoundingBoxMax();
 	
-	// Update the normals of all polygons
-	for(std::vector<triangle>::iterator tri = polys.begin(); tri != polys.end(); tri++)
-		tri->update();
+	// The sphere only needs its center rotated
+	sphereCenter = rotation*geometry->getBoundingSphereCenter();
+	
+	// Enclose the rotated object-space box with an axis-aligned box
+	vector3 center = rotation*((localMin + localMax)*0.5);
+	vector3 half = (localMax - localMin)*0.5;
+	vector3 extent;
+	extent.x = std::fabs(rotation.elements[0][0])*half.x + std::fabs(rotation.elements[0][1])*half.y + std::fabs(rotation.elements[0][2])*half.z;
+	extent.y = std::fabs(rotation.elements[1][0])*half.x + std::fabs(rotation.elements[1][1])*half.y + std::fabs(rotation.elements[1][2])*half.z;
+	extent.z = std::fabs(rotation.elements[2][0])*half.x + std::fabs(rotation.elements[2][1])*half.y + std::fabs(rotation.elements[2][2])*half.z;
+	boxMin = center - extent;
+	boxMax = center + extent;
+	boundsChanged = false;
+}
+
+void object::updateTree(){
+	if(tree)
+		tree->update(this);
+}
+
+mesh& object::getUniqueMesh(){
+	if(geometry.use_count() > 1) // Copy-on-write, other objects keep the original
+		geometry = std::make_shared<mesh>(*geometry);
+	return *geometry;
 }
 
 void object::addVertex(const double &x, const double &y, const double &z){ 
-	vertices0.push_back(vector3(x, y, z)); 
-	vertices.push_back(vertices0.back());
+	getUniqueMesh().addVertex(vector3f(x, y, z));
+	boundsChanged = true;
+	shading.invalidate();
+	updateTree();
 }
 
 void object::addPolygon(const size_t &i0, const size_t &i1, const size_t &i2){
-	polys.push_back(triangle(vertices[i0], vertices[i1], vertices[i2]));
+	getUniqueMesh().addTriangle((unsigned int)i0, (unsigned int)i1, (unsigned int)i2);
+	shading.invalidate();
 }
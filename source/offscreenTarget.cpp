@@ -0,0 +1,15 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#include "offscreenTarget.hpp"
+
+void offscreenTarget::render(){
+	if(!prefix.empty()){
+		std::stringstream stream;
+		stream << prefix << "_" << std::setw(5) << std::setfill('0') << frameCount << ".ppm";
+		if(!buffer.write(stream.str()))
+			std::cout << " offscreenTarget: Error! Failed to write frame to \"" << stream.str() << "\"\n";
+	}
+	frameCount++;
+}
@@ -0,0 +1,12 @@
+#include <iostream>
+
+#include "quaternion.hpp"
+
+template <typename T>
+void quaternionT<T>::dump() const {
+	std::cout << "w=" << w << ", x=" << x << ", y=" << y << ", z=" << z << std::endl;
+}
+
+// Compile the out-of-line members for both scalar types
+template class quaternionT<float>;
+template class quaternionT<double>;
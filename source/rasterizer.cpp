@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <cmath>
+
+#include "rasterizer.hpp"
+#include "frameBuffer.hpp"
+#include "depthBuffer.hpp"
+
+/** Find the first pixel of a scanline span which passes the depth test
+  * @return The index of the first visible pixel, or x2+1 if the entire span is hidden
+  */
+template <typename T>
+int findVisiblePixel(const T *depthRow, int x, const int &x2, float q, const float &dq, const float &scale){
+	for(; x <= x2; x++, q += dq){
+		if((T)(q*scale) > depthRow[x])
+			break;
+	}
+	return x;
+}
+
+/** Write all pixels of a scanline span which pass the depth test
+  * @note The span is rejected early, without writing anything, if all of its pixels are hidden
+  */
+template <typename T>
+void writeVisiblePixels(T *depthRow, unsigned int *colorRow, int x, const int &x2, float q, const float &dq, const float &scale, const unsigned int &color){
+	int first = findVisiblePixel(depthRow, x, x2, q, dq, scale);
+	if(first > x2) // Entire span is hidden
+		return;
+	q += (first-x)*dq;
+	for(x = first; x <= x2; x++, q += dq){
+		T value = (T)(q*scale);
+		if(value > depthRow[x]){
+			depthRow[x] = value;
+			colorRow[x] = color;
+		}
+	}
+}
+
+/** Divide two integers, rounding toward negative infinity
+  * @note The denominator must be positive
+  */
+static inline long long floorDivide(const long long &num, const long long &den){
+	return (num >= 0 ? num/den : -((-num + den - 1)/den));
+}
+
+/** Scanline fill a triangle by finding the span of pixel centers on each row which lie inside all three edges
+  */
+template <typename T>
+void fillScanlines(const halfSpaceTriangle &tri, const halfSpaceTarget &target, T *depth){
+	int minX = std::max(tri.minX, target.clipMinX);
+	int minY = std::max(tri.minY, target.clipMinY);
+	int maxX = std::min(tri.maxX, target.clipMaxX);
+	int maxY = std::min(tri.maxY, target.clipMaxY);
+	for(int y = minY; y < maxY; y++){
+		long long spanStart = minX;
+		long long spanStop = maxX-1;
+		for(int i = 0; i < 3; i++){
+			// Solve A*x + K >= 0 for x, where K is the edge function at the start of the row
+			long long K = tri.C[i] + (long long)tri.B[i]*y;
+			if(tri.A[i] > 0)
+				spanStart = std::max(spanStart, -floorDivide(K, tri.A[i]));
+			else if(tri.A[i] < 0)
+				spanStop = std::min(spanStop, floorDivide(K, -tri.A[i]));
+			else if(K < 0) // Entire row is outside of this edge
+				spanStop = spanStart-1;
+		}
+		if(spanStart > spanStop)
+			continue;
+
+		// Evaluate the depth plane at both ends of the span
+		int x0 = (int)spanStart;
+		int x1 = (int)spanStop;
+		float qStart = (float)(tri.qRef + tri.dqdx*(x0-tri.qRefX) + tri.dqdy*(y-tri.qRefY));
+		float qStop = (float)(tri.qRef + tri.dqdx*(x1-tri.qRefX) + tri.dqdy*(y-tri.qRefY));
+		qStart = std::min(std::max(qStart, 0.f), 1.f);
+		qStop = std::min(std::max(qStop, 0.f), 1.f);
+		float dq = (x1 > x0 ? (qStop-qStart)/(x1-x0) : 0);
+
+		size_t offset = (size_t)y*target.width;
+		writeVisiblePixels(&depth[offset], &target.color[offset], x0, x1, qStart, dq, target.scale, tri.color);
+	}
+}
+
+rasterizer::rasterizer() : colorBuffer(NULL), depthBuf(NULL),
+                           clipMinX(0), clipMinY(0), clipMaxX(0), clipMaxY(0),
+                           method(HALFSPACE), simd(SIMD_NONE), kernel(fillHalfSpaceScalar),
+                           tileSize(DEFAULT_TILE_SIZE), nTilesX(0), nTilesY(0),
+                           pool() {
+	setSimdLevel(SIMD_AVX2);
+}
+
+void rasterizer::setBuffers(frameBuffer *color_, depthBuffer *depth_){
+	colorBuffer = color_;
+	depthBuf = depth_;
+	setClipRegion(0, 0, colorBuffer->getWidth(), colorBuffer->getHeight());
+}
+
+void rasterizer::setClipRegion(const int &minX, const int &minY, const int &maxX, const int &maxY){
+	clipMinX = std::max(minX, 0);
+	clipMinY = std::max(minY, 0);
+	clipMaxX = (colorBuffer ? std::min(maxX, colorBuffer->getWidth()) : maxX);
+	clipMaxY = (colorBuffer ? std::min(maxY, colorBuffer->getHeight()) : maxY);
+	updateTiles();
+}
+
+void rasterizer::setSimdLevel(const simdLevel &level){
+	simd = std::min(level, getSupportedSimdLevel());
+	switch(simd){
+		case SIMD_AVX2:
+			kernel = fillHalfSpaceAVX2;
+			break;
+		case SIMD_SSE2:
+			kernel = fillHalfSpaceSSE2;
+			break;
+		default:
+			kernel = fillHalfSpaceScalar;
+			break;
+	}
+}
+
+void rasterizer::setTileSize(const int &size){
+	tileSize = (size > 0 ? (size + 7) & ~7 : DEFAULT_TILE_SIZE);
+	updateTiles();
+}
+
+void rasterizer::addTriangle(const scene::pixelTriplet &coords, const unsigned int &color){
+	int x[3] = {coords.pX[0], coords.pX[1], coords.pX[2]};
+	int y[3] = {coords.pY[0], coords.pY[1], coords.pY[2]};
+	float q[3] = {coords.pZ[0], coords.pZ[1], coords.pZ[2]};
+
+	// Twice the signed area of the triangle (in square sub-pixels)
+	long long area = (long long)(x[1]-x[0])*(y[2]-y[0]) - (long long)(x[2]-x[0])*(y[1]-y[0]);
+	if(area == 0) // Degenerate triangle
+		return;
+	if(area < 0){ // Reverse the winding so that the inside of every edge is positive
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(q[1], q[2]);
+		area = -area;
+	}
+
+	halfSpaceTriangle tri;
+
+	// Compute the bounding box of all pixels whose centers may lie inside the triangle and clip it to the drawable region
+	tri.minX = std::max(std::min(x[0], std::min(x[1], x[2])) >> SUBPIXEL_BITS, clipMinX);
+	tri.minY = std::max(std::min(y[0], std::min(y[1], y[2])) >> SUBPIXEL_BITS, clipMinY);
+	tri.maxX = std::min((std::max(x[0], std::max(x[1], x[2])) >> SUBPIXEL_BITS)+1, clipMaxX);
+	tri.maxY = std::min((std::max(y[0], std::max(y[1], y[2])) >> SUBPIXEL_BITS)+1, clipMaxY);
+	if(tri.minX >= tri.maxX || tri.minY >= tri.maxY) // Triangle is entirely off the screen
+		return;
+
+	// Setup the edge functions for edges 0->1, 1->2, and 2->0. The functions are stepped one whole
+	//  pixel at a time and are evaluated at the center of each pixel
+	const long long halfPixel = SUBPIXEL_SCALE/2;
+	for(int i = 0; i < 3; i++){
+		int j = (i+1) % 3;
+		int A = y[i] - y[j];
+		int B = x[j] - x[i];
+		tri.A[i] = A*SUBPIXEL_SCALE;
+		tri.B[i] = B*SUBPIXEL_SCALE;
+		tri.C[i] = (long long)x[i]*y[j] - (long long)x[j]*y[i] + (A + B)*halfPixel;
+
+		// Top-left fill rule. Pixel centers lying exactly on an edge are only inside of the triangle
+		//  if the edge is a left edge or a horizontal edge along the top of the triangle
+		if(!(A > 0 || (A == 0 && B > 0)))
+			tri.C[i] -= 1;
+	}
+
+	// Setup the depth plane, referenced to pixel centers
+	double invArea = double(SUBPIXEL_SCALE)/area;
+	tri.qRefX = double(x[0])/SUBPIXEL_SCALE - 0.5;
+	tri.qRefY = double(y[0])/SUBPIXEL_SCALE - 0.5;
+	tri.qRef = q[0];
+	tri.dqdx = ((q[1]-q[0])*double(y[2]-y[0]) - (q[2]-q[0])*double(y[1]-y[0]))*invArea;
+	tri.dqdy = ((q[2]-q[0])*double(x[1]-x[0]) - (q[1]-q[0])*double(x[2]-x[0]))*invArea;
+	tri.color = color;
+
+	unsigned int index = (unsigned int)triangles.size();
+	triangles.push_back(tri);
+
+	// Add the triangle to every tile overlapped by its bounding box
+	for(int ty = tri.minY/tileSize; ty <= (tri.maxY-1)/tileSize; ty++){
+		for(int tx = tri.minX/tileSize; tx <= (tri.maxX-1)/tileSize; tx++)
+			bins[(size_t)ty*nTilesX+tx].push_back(index);
+	}
+}
+
+void rasterizer::flush(){
+	if(!triangles.empty() && colorBuffer && depthBuf){
+		// Only schedule tiles which have something to draw
+		activeTiles.clear();
+		for(size_t i = 0; i < bins.size(); i++){
+			if(!bins[i].empty())
+				activeTiles.push_back(i);
+		}
+
+		// Rasterize all tiles in parallel
+		pool.run(activeTiles.size(), [this](const size_t &i){ rasterizeTile(activeTiles[i]); });
+	}
+
+	// Reset for the next frame
+	triangles.clear();
+	for(std::vector<std::vector<unsigned int> >::iterator bin = bins.begin(); bin != bins.end(); bin++)
+		bin->clear();
+}
+
+rasterizer::simdLevel rasterizer::getSupportedSimdLevel(){
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	if(halfSpaceAVX2Compiled() && __builtin_cpu_supports("avx2"))
+		return SIMD_AVX2;
+	if(halfSpaceSSE2Compiled() && __builtin_cpu_supports("sse2"))
+		return SIMD_SSE2;
+#endif
+	return SIMD_NONE;
+}
+
+void rasterizer::updateTiles(){
+	nTilesX = (clipMaxX + tileSize - 1)/tileSize;
+	nTilesY = (clipMaxY + tileSize - 1)/tileSize;
+	triangles.clear();
+	bins.assign((size_t)nTilesX*nTilesY, std::vector<unsigned int>());
+}
+
+void rasterizer::rasterizeTile(const size_t &index){
+	// Compute the pixel bounds of the tile
+	int tx = (int)(index % nTilesX);
+	int ty = (int)(index / nTilesX);
+
+	halfSpaceTarget target;
+	target.color = colorBuffer->get();
+	target.format = depthBuf->getFormat();
+	switch(target.format){
+		case depthBuffer::FIXED16:
+			target.depth = depthBuf->getRowFixed16(0);
+			break;
+		case depthBuffer::FIXED24:
+			target.depth = depthBuf->getRowFixed24(0);
+			break;
+		default:
+			target.depth = depthBuf->getRowFloat(0);
+			break;
+	}
+	target.scale = depthBuf->getScale();
+	target.width = colorBuffer->getWidth();
+	target.clipMinX = std::max(tx*tileSize, clipMinX);
+	target.clipMinY = std::max(ty*tileSize, clipMinY);
+	target.clipMaxX = std::min((tx+1)*tileSize, clipMaxX);
+	target.clipMaxY = std::min((ty+1)*tileSize, clipMaxY);
+
+	// Draw all triangles in submission order
+	const std::vector<unsigned int> &bin = bins[index];
+	if(method == HALFSPACE){
+		for(std::vector<unsigned int>::const_iterator iter = bin.begin(); iter != bin.end(); iter++)
+			(*kernel)(triangles[*iter], target);
+	}
+	else{
+		for(std::vector<unsigned int>::const_iterator iter = bin.begin(); iter != bin.end(); iter++)
+			fillTriangle(triangles[*iter], target);
+	}
+}
+
+void rasterizer::fillTriangle(const halfSpaceTriangle &tri, const halfSpaceTarget &target){
+	switch(target.format){
+		case depthBuffer::FIXED16:
+			fillScanlines(tri, target, (unsigned short*)target.depth);
+			break;
+		case depthBuffer::FIXED24:
+			fillScanlines(tri, target, (unsigned int*)target.depth);
+			break;
+		default:
+			fillScanlines(tri, target, (float*)target.depth);
+			break;
+	}
+}
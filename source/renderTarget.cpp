@@ -0,0 +1,23 @@
+#include "renderTarget.hpp"
+
+void renderTarget::drawPixel(const int *x, const int *y, const size_t &N){
+	for(size_t i = 0; i < N; i++) // Draw N pixels
+		drawPixel(x[i], y[i]);
+}
+
+void renderTarget::drawLine(const int *x, const int *y, const size_t &N){
+	if(N == 0) // Nothing to draw
+		return;
+	for(size_t i = 0; i < N-1; i++)
+		drawLine(x[i], y[i], x[i+1], y[i+1]);
+}
+
+void renderTarget::initialize(){
+	if(init) return;
+
+	// Allocate the framebuffer
+	buffer.resize(W, H);
+	clear();
+
+	init = true;
+}
@@ -24,8 +24,11 @@ int main(){
 	// Show some info about the camera
 	cam.dump();
 	
+	// Open the window which the scene will be drawn to
+	sdlWindow window(640, 480);
+	
 	// Setup the scene with our camera
-	scene myScene(&cam);
+	scene myScene(&cam, &window);
 	//myScene.getWorldLight()->setColor(Colors::RED);
 	
 	// Set the camera to draw surface normal vectors
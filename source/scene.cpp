@@ -1,36 +1,195 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 #include <unistd.h>
 
 #include "scene.hpp"
 #include "camera.hpp"
 #include "object.hpp"
-#include "sdlWindow.hpp"
+#include "offscreenTarget.hpp"
+#include "frameBuffer.hpp"
+#include "rasterizer.hpp"
 
 #define SCREEN_XLIMIT 1.0 ///< Set the horizontal clipping border as a fraction of the total screen width
 #define SCREEN_YLIMIT 1.0 ///< Set the vertical clipping border as a fraction of the total screen height
 
-scene::scene() : timeElapsed(0), totalRenderTime(0), renderTime(0), framerate(0), framerateCap(60), updateCount(0), 
-                 drawNorm(false), drawOrigin(false), isRunning(true), 
+#define EDGE_DEPTH_BIAS 1E-3 ///< Relative depth tolerance used when drawing triangle edges on top of filled triangles
+
+#define SUBPIXEL_LIMIT 2097152.0 ///< Largest magnitude of a sub-pixel coordinate which the rasterizer edge functions can handle without overflow
+
+#define GUARD_BAND 32.0 ///< Extent of the guard band, as a multiple of the screen-space limits, outside of which triangles are clipped in x and y
+
+#define MAX_CLIP_VERTICES 9 ///< Maximum number of vertices of a triangle clipped against all of the clipping planes
+
+#define LOD_PIXEL_ERROR 1.0 ///< Largest geometric error of a level of detail, projected onto the screen, which is allowed with no bias (in pixels)
+
+/** Clipping planes used when computing vertex outcodes
+  */
+enum clipPlane {CLIP_LEFT   = 0x001, ///< Left edge of the screen
+                CLIP_RIGHT  = 0x002, ///< Right edge of the screen
+                CLIP_BOTTOM = 0x004, ///< Bottom edge of the screen
+                CLIP_TOP    = 0x008, ///< Top edge of the screen
+                CLIP_NEAR   = 0x010, ///< The viewing plane of the camera
+                GUARD_LEFT  = 0x020, ///< Left edge of the guard band
+                GUARD_RIGHT = 0x040, ///< Right edge of the guard band
+                GUARD_BOTTOM= 0x080, ///< Bottom edge of the guard band
+                GUARD_TOP   = 0x100  ///< Top edge of the guard band
+};
+
+const unsigned short CLIP_FRUSTUM = CLIP_LEFT | CLIP_RIGHT | CLIP_BOTTOM | CLIP_TOP | CLIP_NEAR; ///< Planes used to reject triangles
+const unsigned short CLIP_GEOMETRY = CLIP_NEAR | GUARD_LEFT | GUARD_RIGHT | GUARD_BOTTOM | GUARD_TOP; ///< Planes which triangles are clipped against
+
+/** @class clipVertex
+  * @brief Vertex of a polygon which is being clipped in homogeneous clip-space
+  */
+class clipVertex{
+public:
+	double x; ///< The x-component of the vertex
+	double y; ///< The y-component of the vertex
+	double z; ///< The z-component of the vertex
+	double w; ///< The homogeneous w-component of the vertex
+
+	bool edge; ///< Flag indicating that the edge from this vertex to the next one lies along an edge of the original triangle
+
+	/** Get the signed distance from the vertex to a clipping plane (positive values are inside)
+	  */
+	double distance(const clipPlane &plane) const {
+		switch(plane){
+			case CLIP_NEAR:
+				return w - z; // The projection keeps z constant, at the distance to the viewing plane
+			case GUARD_LEFT:
+				return x + GUARD_BAND*SCREEN_XLIMIT*w;
+			case GUARD_RIGHT:
+				return GUARD_BAND*SCREEN_XLIMIT*w - x;
+			case GUARD_BOTTOM:
+				return y + GUARD_BAND*SCREEN_YLIMIT*w;
+			case GUARD_TOP:
+				return GUARD_BAND*SCREEN_YLIMIT*w - y;
+			default:
+				return 0;
+		}
+	}
+};
+
+/** Compute the bit mask of clipping planes which a clip-space point lies outside of
+  */
+static unsigned short computeOutcode(const double &x, const double &y, const double &z, const double &w){
+	unsigned short code = 0;
+	if(x < -SCREEN_XLIMIT*w) code |= CLIP_LEFT;
+	if(x > SCREEN_XLIMIT*w) code |= CLIP_RIGHT;
+	if(y < -SCREEN_YLIMIT*w) code |= CLIP_BOTTOM;
+	if(y > SCREEN_YLIMIT*w) code |= CLIP_TOP;
+	if(w <= z) code |= CLIP_NEAR;
+	if(x < -GUARD_BAND*SCREEN_XLIMIT*w) code |= GUARD_LEFT;
+	if(x > GUARD_BAND*SCREEN_XLIMIT*w) code |= GUARD_RIGHT;
+	if(y < -GUARD_BAND*SCREEN_YLIMIT*w) code |= GUARD_BOTTOM;
+	if(y > GUARD_BAND*SCREEN_YLIMIT*w) code |= GUARD_TOP;
+	return code;
+}
+
+/** Get the position of the lowest set bit of a non-zero word
+  */
+static inline unsigned int lowestSetBit(const unsigned int &bits){
+#if defined(__GNUC__)
+	return __builtin_ctz(bits);
+#else
+	unsigned int index = 0;
+	while(!(bits & (1u << index)))
+		index++;
+	return index;
+#endif
+}
+
+/** Return true if a sphere lies entirely outside of one of the frustum planes used to reject triangles (see CLIP_FRUSTUM)
+  * @note The far plane is not tested, since individual triangles are not rejected by it either
+  */
+static bool isOutsideFrustum(const camera *cam, const vector3 &center, const double &radius){
+	const frustumPlane planes[5] = {FRUSTUM_LEFT, FRUSTUM_RIGHT, FRUSTUM_BOTTOM, FRUSTUM_TOP, FRUSTUM_NEAR};
+	for(size_t i = 0; i < 5; i++){
+		if(cam->getFrustumPlane(planes[i]).distance(center) < -radius)
+			return true;
+	}
+	return false;
+}
+
+/** Return true if any of a list of boxes lies at least partially inside of the viewing frustum of a camera
+  */
+static bool anyInFrustum(const camera *cam, const std::vector<bvh::region> &regions){
+	for(std::vector<bvh::region>::const_iterator r = regions.begin(); r != regions.end(); r++){
+		if(cam->checkFrustum(r->boxMin, r->boxMax))
+			return true;
+	}
+	return false;
+}
+
+/** Clip a convex polygon against a single plane (Sutherland-Hodgman)
+  * @return The number of vertices in the output polygon
+  */
+static size_t clipPolygon(const clipVertex *input, const size_t &nInput, clipVertex *output, const clipPlane &plane){
+	size_t nOutput = 0;
+	for(size_t i = 0; i < nInput; i++){
+		const clipVertex &a = input[i];
+		const clipVertex &b = input[(i+1) % nInput];
+		double dA = a.distance(plane);
+		double dB = b.distance(plane);
+		if(dA >= 0) // Vertex is inside
+			output[nOutput++] = a;
+		if((dA >= 0) != (dB >= 0)){ // Edge crosses the plane
+			double t = dA/(dA - dB);
+			clipVertex &p = output[nOutput++];
+			p.x = a.x + t*(b.x - a.x);
+			p.y = a.y + t*(b.y - a.y);
+			p.z = a.z + t*(b.z - a.z);
+			p.w = a.w + t*(b.w - a.w);
+			
+			// Leaving the inside, the next edge runs along the clipping plane
+			p.edge = (dA < 0 ? a.edge : false);
+		}
+	}
+	return nOutput;
+}
+
+/** Snap a pixel-space coordinate to the nearest sub-pixel, clamping it to the range supported by the rasterizer
+  */
+static int snapToSubPixel(const double &p){
+	double value = std::floor(p*SUBPIXEL_SCALE + 0.5);
+	return (int)std::min(std::max(value, -SUBPIXEL_LIMIT), SUBPIXEL_LIMIT);
+}
+
+scene::scene() : timeElapsed(0), totalRenderTime(0), renderTime(0), framerate(0), framerateCap(60), lodBias(0), updateCount(0), 
+                 drawNorm(false), drawOrigin(false), srgbOutput(false), isRunning(true), lightingRevision(0), shadowMapSize(DEFAULT_SHADOW_MAP_SIZE), shadowBias(DEFAULT_SHADOW_BIAS), 
                  screenWidthPixels(640), screenHeightPixels(480), 
                  minPixelsX(0), minPixelsY(0),
                  maxPixelsX(640), maxPixelsY(480),
-                 cam(NULL) { 
+                 cam(NULL), window(NULL), ownsWindow(false), raster(NULL) { 
 	initialize();
 }
 
-scene::scene(camera *cam_) : timeElapsed(0), totalRenderTime(0), renderTime(0), framerate(0), framerateCap(60), updateCount(0),
-                             drawNorm(false), drawOrigin(false), isRunning(true), 
+scene::scene(camera *cam_) : timeElapsed(0), totalRenderTime(0), renderTime(0), framerate(0), framerateCap(60), lodBias(0), updateCount(0),
+                             drawNorm(false), drawOrigin(false), srgbOutput(false), isRunning(true), lightingRevision(0), shadowMapSize(DEFAULT_SHADOW_MAP_SIZE), shadowBias(DEFAULT_SHADOW_BIAS), 
                              screenWidthPixels(640), screenHeightPixels(480), 
                              minPixelsX(0), minPixelsY(0),
                              maxPixelsX(640), maxPixelsY(480),
-                             cam(cam_) { 
+                             cam(cam_), window(NULL), ownsWindow(false), raster(NULL) { 
+	initialize();
+	setCamera(cam_);
+}
+
+scene::scene(camera *cam_, renderTarget *target_) : timeElapsed(0), totalRenderTime(0), renderTime(0), framerate(0), framerateCap(60), lodBias(0), updateCount(0),
+                                                    drawNorm(false), drawOrigin(false), srgbOutput(false), isRunning(true), lightingRevision(0), shadowMapSize(DEFAULT_SHADOW_MAP_SIZE), shadowBias(DEFAULT_SHADOW_BIAS), 
+                                                    screenWidthPixels(target_->getWidth()), screenHeightPixels(target_->getHeight()), 
+                                                    minPixelsX(0), minPixelsY(0),
+                                                    maxPixelsX(target_->getWidth()), maxPixelsY(target_->getHeight()),
+                                                    cam(cam_), window(target_), ownsWindow(false), raster(NULL) { 
 	initialize();
 	setCamera(cam_);
 }
 
 scene::~scene(){
-	// The SDL window's destructor will automatically handle its own clean-up
-	delete window;
+	// The render target's destructor will automatically handle its own clean-up
+	if(ownsWindow)
+		delete window;
+	delete raster;
 }
 
 void scene::initialize(){
@@ -38,19 +197,32 @@ void scene::initialize(){
 	timeOfInitialization = sclock::now();
 	timeOfLastUpdate = sclock::now();
 
-	// Setup the window
-	window = new sdlWindow(screenWidthPixels, screenHeightPixels);
+	// Setup the render target
+	if(!window){
+		window = new offscreenTarget(screenWidthPixels, screenHeightPixels);
+		ownsWindow = true;
+	}
 	window->initialize();
 	
+	// Setup the depth buffer to match the render target
+	depth.resize(window->getWidth(), window->getHeight());
+
+	// Setup the tile rasterizer
+	if(!raster)
+		raster = new rasterizer();
+	raster->setBuffers(window->getBuffer(), &depth);
+	
 	// Set the pixel coordinate bounds
 	minPixelsX = (int)(screenWidthPixels*(1-SCREEN_YLIMIT)/2);
 	maxPixelsX = (int)(screenWidthPixels-minPixelsX);
 	minPixelsY = (int)(screenHeightPixels*(1-SCREEN_YLIMIT)/2);
 	maxPixelsY = (int)(screenHeightPixels-minPixelsX);
+	raster->setClipRegion(minPixelsX, minPixelsY, maxPixelsX, maxPixelsY);
 }
 
 void scene::clear(const sdlColor &color/*=Colors::BLACK*/){
 	window->clear(color);
+	depth.clear();
 }
 
 bool scene::update(){
@@ -60,23 +232,48 @@ bool scene::update(){
 	// Start the render timer
 	sclock::time_point startOfRenderScene = sclock::now();
 	
-	// Clear the vector of triangles to draw
-	polygonsToDraw.clear();
+	// Clear the vectors of edges and normals to draw
+	edgesToDraw.clear();
+	normalsToDraw.clear();
 
 	// Clear the screen with a color
 	clear(Colors::BLACK);
 	
+	// Check whether any light has changed since the last frame
+	updateLighting();
+	
 	// Draw the 3d geometry
-	for(auto obj : objects)
-		processObject(obj);
+	// Only objects which are at least partially inside the viewing frustum are processed
+	visibleObjects.clear();
+	objectTree.queryFrustum(cam, visibleObjects);
 	
-	// Draw rendered polygons
-	if(!polygonsToDraw.empty()){
-		for(auto triplet : polygonsToDraw){
-			sdlColor col = worldLight.getColor(triplet.tri);
-			drawFilledTriangle(triplet, col);
+	// Pick the level of detail of each visible object and group the objects by the mesh which they will draw, so
+	//  that each mesh is set up only once
+	double maxPixelError = LOD_PIXEL_ERROR*std::pow(2.0, lodBias);
+	batchIndex.clear();
+	batchMeshes.clear();
+	for(auto obj : visibleObjects){
+		const mesh *geometry = selectLevel(obj, maxPixelError);
+		auto entry = batchIndex.insert(std::make_pair(geometry, batchIndex.size()));
+		if(entry.second){ // First instance of this mesh
+			if(meshBatches.size() < batchIndex.size())
+				meshBatches.resize(batchIndex.size());
+			meshBatches[entry.first->second].clear();
+			batchMeshes.push_back(geometry);
 		}
+		meshBatches[entry.first->second].push_back(obj);
 	}
+	for(size_t i = 0; i < batchMeshes.size(); i++)
+		processMesh(batchMeshes[i], meshBatches[i]);
+	
+	// Rasterize all filled triangles
+	raster->flush();
+	
+	// Draw triangle edges and normals on top of the filled triangles
+	for(std::vector<edgeTriplet>::iterator edge = edgesToDraw.begin(); edge != edgesToDraw.end(); edge++)
+		drawTriangle(edge->coords, (edge->depthTest ? Colors::BLACK : Colors::WHITE), edge->depthTest, edge->edges);
+	for(std::vector<ray>::iterator norm = normalsToDraw.begin(); norm != normalsToDraw.end(); norm++)
+		drawRay((*norm), Colors::RED);
 
 	if(drawOrigin){ // Draw the origin
 		drawVector(vector3(0, 0, 0), vector3(1, 0, 0), Colors::RED);
@@ -136,51 +333,340 @@ void scene::setCamera(camera *cam_){
 	cam->setAspectRatio(double(screenWidthPixels)/screenHeightPixels);
 }
 
-void scene::processObject(object *obj){
-	std::vector<triangle>* polys = obj->getPolygons();
-	vector3 offset = obj->getPosition();
-	drawMode mode = obj->getDrawingMode();
-	for(std::vector<triangle>::iterator iter = polys->begin(); iter != polys->end(); iter++){
-		// Do backface culling
-		if(mode != WIREFRAME && !cam->checkCulling(offset, (*iter))) // The triangle is facing away from the camera
-			continue;
-		
-		// Render the triangle by converting its projection on the camera's viewing plane into pixel coordinates
-		double sX[3], sY[3];
-		bool valid[3];
-		cam->render(offset, (*iter), sX, sY, valid);
-		
-		// Check that all vertices are in front of the camera
-		// Relatively crude for now because one or more vertices may still be in front of us
-		if(!valid[0] || !valid[1] || !valid[2])
+void scene::projectVertices(const object *obj, const mesh *geometry){
+	const vertexArray *vertices = geometry->getVertices();
+	const float *vX = vertices->getX();
+	const float *vY = vertices->getY();
+	const float *vZ = vertices->getZ();
+	
+	// Compose the object's model matrix with the camera once, so each vertex takes a single transform
+	matrix4 modelViewProj = cam->getViewProjectionMatrix()*obj->getModelMatrix();
+	projectedVertices.resize(vertices->size());
+	std::vector<projectedVertex>::iterator proj = projectedVertices.begin();
+	for(size_t i = 0; i < vertices->size(); i++, proj++){
+		// Transform the object-space vertex into clip-space
+		modelViewProj.transform(vector3(vX[i], vY[i], vZ[i]), proj->cX, proj->cY, proj->cZ, proj->cW);
+		proj->outcode = computeOutcode(proj->cX, proj->cY, proj->cZ, proj->cW);
+		if(proj->outcode & CLIP_NEAR) // Vertex must be clipped before it can be projected
 			continue;
 		
 		// Convert to pixel coordinates
 		// (0, 0) is at the top-left of the screen
-		pixelTriplet pixels(&(*iter));
-		if(!convertToPixelSpace(sX, sY, pixels)) // Check if the triangle is on the screen
-			continue;
+		double invW = 1/proj->cW;
+		proj->pX = snapToSubPixel(screenWidthPixels*((proj->cX*invW + 1)/2));
+		proj->pY = snapToSubPixel(screenHeightPixels*(1 - (proj->cY*invW + 1)/2));
+		proj->pZ = (float)(proj->cZ*invW);
+	}
+}
+
+void scene::addObject(object *obj){
+	// Simplify the object's mesh now rather than while drawing. Meshes shared between objects are only simplified once
+	obj->getMesh()->buildLevelsOfDetail();
+	objects.push_back(obj);
+	objectTree.insert(obj);
+}
+
+object* scene::pickObject(const int &px, const int &py, double &t){
+	// Cast a ray through the center of the pixel
+	double sX = 2*(px + 0.5)/screenWidthPixels - 1;
+	double sY = 1 - 2*(py + 0.5)/screenHeightPixels;
+	return objectTree.raycast(cam->getRay(sX, sY), t);
+}
+
+const mesh* scene::selectLevel(const object *obj, const double &maxPixelError) const {
+	const mesh *geometry = obj->getMesh();
+	if(geometry->getNumberOfLevels() == 1)
+		return geometry;
+	
+	// Depth of the nearest point of the bounding sphere along the viewing axis
+	double x, y, z, w;
+	double radius = obj->getBoundingSphereRadius();
+	cam->getViewMatrix().transform(obj->getBoundingSphereCenter(), x, y, z, w);
+	double depth = z - radius;
+	if(depth <= cam->getFocalLength()) // Sphere reaches the viewing plane
+		return geometry;
+	
+	// The projected size of the bounding sphere gives the number of pixels covered by one unit of length on the
+	//  object. Use the coarsest level whose error projects to no more than the allowed number of pixels
+	double projectedRadius = radius*screenHeightPixels*cam->getFocalLength()/(cam->getViewingPlaneHeight()*depth);
+	double maxError = maxPixelError*radius/projectedRadius;
+	size_t level = 0;
+	while(level+1 < geometry->getNumberOfLevels() && geometry->getLevelError(level+1) <= maxError)
+		level++;
+	return geometry->getLevel(level);
+}
+
+void scene::processMesh(const mesh *geometry, const std::vector<object*> &instances){
+	// Walk the index buffer using its own index width
+	const indexBuffer *indices = geometry->getIndices();
+	if(indices->getFormat() == indexBuffer::INDEX_16)
+		processInstances(geometry, instances, indices->getShortIndices());
+	else
+		processInstances(geometry, instances, indices->getIntIndices());
+}
+
+template <typename IndexT>
+void scene::processInstances(const mesh *geometry, const std::vector<object*> &instances, const IndexT *indices){
+	const float *nX = geometry->getNormals()->getX();
+	const float *nY = geometry->getNormals()->getY();
+	const float *nZ = geometry->getNormals()->getZ();
+	const float *cX = geometry->getCentroids()->getX();
+	const float *cY = geometry->getCentroids()->getY();
+	const float *cZ = geometry->getCentroids()->getZ();
+	
+	const size_t nTriangles = geometry->getNumberOfTriangles();
+	if(nTriangles == 0)
+		return;
+	const std::vector<meshlet> &clusters = geometry->getMeshlets();
+	
+	for(std::vector<object*>::const_iterator obj = instances.begin(); obj != instances.end(); obj++){
+		vector3 offset = (*obj)->getPosition();
+		const matrix3 &rot = (*obj)->getRotation();
+		drawMode mode = (*obj)->getDrawingMode();
+		sdlColor baseColor = (*obj)->getColor();
+		
+		// Project each unique vertex once. Triangles sharing a vertex all use the same projection
+		projectVertices(*obj, geometry);
 		
-		// Draw the triangle to the screen
-		if(mode == WIREFRAME || mode == MESH){
-			drawTriangle(pixels, Colors::WHITE);
+		// Colors from earlier frames are kept until the object or the lights change
+		shadingCache &cache = (*obj)->getShadingCache();
+		if(mode == RENDER){
+			setShadowRevisions(*obj);
+			cache.update(geometry, lightingRevision, shadowRevisions);
 		}
-		else if(mode == SOLID){
-			// Draw the triangle face and the outline of the triangle
-			drawFilledTriangle(pixels, Colors::WHITE);
+		shadingLights.clear();
 		
-			// Draw the edges of the triangles
-			drawTriangle(pixels, Colors::BLACK);
+		// Move the camera into the object's reference frame, so that the object-space polygons can be culled directly
+		vector3 eye = cam->getPosition() - offset;
+		rot.transpose(eye);
+		
+		// Reject whole meshlets which are outside of the viewing frustum or which face away from the camera, then
+		//  do backface culling on the triangles of the remaining meshlets, one meshlet at a time
+		faceMask.assign((nTriangles + 31)/32, 0);
+		for(std::vector<meshlet>::const_iterator cluster = clusters.begin(); cluster != clusters.end(); cluster++){
+			if(isOutsideFrustum(cam, rot*cluster->center + offset, cluster->radius))
+				continue;
+			if(mode == WIREFRAME){ // Draw every triangle
+				for(size_t i = cluster->first; i < cluster->first + cluster->count; i++)
+					faceMask[i/32] |= 1u << (i % 32);
+			}
+			else if(!cluster->isBackfacing(eye)){
+				geometry->computeFacing(*cluster, vector3f(eye), &faceMask[0]);
+				const size_t index = cluster - clusters.begin();
+				if(mode == RENDER && !cache.isShaded(index)){ // Shade the whole meshlet at once, rather than one visible triangle at a time
+					if(shadingLights.empty())
+						setShadingLights(*obj, geometry);
+					float *visibility = (shadowVisibility.empty() ? NULL : &shadowVisibility[0]);
+					for(size_t j = 0; j < shadingMaps.size(); j++){ // Find which triangles of the meshlet are shadowed
+						if(shadingMaps[j]){
+							shadingMaps[j]->computeVisibility(*obj, geometry, cluster->first, cluster->count, visibility);
+							visibility += nTriangles + vertexArray::BLOCK_SIZE;
+						}
+					}
+					geometry->computeShading(*cluster, &shadingLights[0], shadingLights.size(), srgbOutput, cache.getColors());
+					cache.setShaded(index);
+				}
+			}
 		}
-		else if(mode == RENDER){
-			// Do nothing for now. Rendering is more complex than wireframe or solid mesh drawing
-			//  because we need to take lighting into account. Add the projected triangle to the
-			//  vector of good vertices for future drawing.
-			polygonsToDraw.push_back(pixels);
+		
+		// Only visit the triangles which face the camera
+		for(size_t word = 0; word < faceMask.size(); word++){
+			for(unsigned int bits = faceMask[word]; bits != 0; bits &= bits - 1){
+				const size_t i = 32*word + lowestSetBit(bits);
+				const IndexT *tri = &indices[3*i];
+				
+				// Reject the triangle if all three vertices lie outside of the same edge of the viewing frustum
+				const projectedVertex *verts[3] = {&projectedVertices[tri[0]], &projectedVertices[tri[1]], &projectedVertices[tri[2]]};
+				if(verts[0]->outcode & verts[1]->outcode & verts[2]->outcode & CLIP_FRUSTUM)
+					continue;
+				
+				unsigned int color = (mode == RENDER ? cache[i] : baseColor.toARGB());
+				
+				unsigned short clipMask = (verts[0]->outcode | verts[1]->outcode | verts[2]->outcode) & CLIP_GEOMETRY;
+				if(clipMask){ // Triangle crosses the near plane or the guard band
+					clipTriangle(verts, clipMask, mode, color);
+				}
+				else{
+					pixelTriplet pixels;
+					for(size_t j = 0; j < 3; j++){
+						pixels.pX[j] = verts[j]->pX;
+						pixels.pY[j] = verts[j]->pY;
+						pixels.pZ[j] = verts[j]->pZ;
+					}
+					submitTriangle(pixels, mode, color);
+				}
+				
+				if(drawNorm) // Draw the surface normal vector (in real-space)
+					normalsToDraw.push_back(ray(rot*vector3(cX[i], cY[i], cZ[i]) + offset, rot*vector3(nX[i], nY[i], nZ[i])));
+			}
 		}
+	}
+}
+
+void scene::setShadingLights(const object *obj, const mesh *geometry){
+	// Move the world light and the lights which are able to reach the object's bounding sphere into object-space,
+	//  tinted by the color of the object, so that the triangles can be shaded without being transformed
+	const vector3 offset = obj->getPosition();
+	const matrix3 &rot = obj->getRotation();
+	vector3 center = obj->getBoundingSphereCenter();
+	double radius = obj->getBoundingSphereRadius();
+	vector3 boxMin = obj->getBoundingBoxMin();
+	vector3 boxMax = obj->getBoundingBoxMax();
+	shadingLights.clear();
+	shadingMaps.clear();
+	for(size_t i = 0; i <= lights.size(); i++){
+		const lightSource *light = (i == 0 ? &worldLight : lights[i-1]);
+		if(i > 0 && !light->illuminates(center, radius))
+			continue;
+		shadingLights.push_back(light->getFaceLight(offset, rot));
+		if(i < shadowMaps.size() && shadowMaps[i].reaches(boxMin, boxMax))
+			shadingMaps.push_back(&shadowMaps[i]);
+		else
+			shadingMaps.push_back(NULL);
+	}
+	linearColor tint = (srgbOutput ? linearColor::fromSRGB(obj->getColor()) : linearColor(obj->getColor()));
+	for(std::vector<faceLight>::iterator light = shadingLights.begin(); light != shadingLights.end(); light++)
+		light->color *= tint;
+	
+	// Each shadowed light gets its own array of visibility factors, which are filled in one meshlet at a time
+	const size_t stride = geometry->getNumberOfTriangles() + vertexArray::BLOCK_SIZE;
+	size_t nShadowed = 0;
+	for(size_t i = 0; i < shadingLights.size(); i++){
+		if(shadingMaps[i])
+			nShadowed++;
+	}
+	shadowVisibility.assign(stride*nShadowed, 1);
+	for(size_t i = 0, slot = 0; i < shadingLights.size(); i++){
+		if(shadingMaps[i])
+			shadingLights[i].visibility = &shadowVisibility[stride*(slot++)];
+	}
+}
+
+void scene::setShadowRevisions(const object *obj){
+	// Same lights as setShadingLights(), so that a map which cannot shadow the object never discards its colors
+	vector3 center = obj->getBoundingSphereCenter();
+	double radius = obj->getBoundingSphereRadius();
+	vector3 boxMin = obj->getBoundingBoxMin();
+	vector3 boxMax = obj->getBoundingBoxMax();
+	shadowRevisions.clear();
+	for(size_t i = 0; i < shadowMaps.size() && i <= lights.size(); i++){
+		const lightSource *light = (i == 0 ? &worldLight : lights[i-1]);
+		if(i > 0 && !light->illuminates(center, radius))
+			continue;
+		shadowRevisions.push_back(shadowMaps[i].reaches(boxMin, boxMax) ? shadowMaps[i].getRevision() : 0);
+	}
+}
+
+void scene::updateLighting(){
+	// Compare the revision of every light with the last frame, including the world light
+	bool changed = (lightRevisions.size() != lights.size() + 1);
+	lightRevisions.resize(lights.size() + 1);
+	shadowMaps.resize(lights.size() + 1);
+	
+	// A shadow map only needs to be redrawn when an object is added, removed, or moved within view of its camera,
+	//  or when the bounds of the scene (which aim the camera) change
+	vector3 sceneMin, sceneMax;
+	const bool hasBounds = objectTree.getBounds(sceneMin, sceneMax);
+	const std::vector<bvh::region> &moved = objectTree.getChanges();
+	
+	for(size_t i = 0; i <= lights.size(); i++){
+		const lightSource *light = (i == 0 ? &worldLight : lights[i-1]);
+		bool lightChanged = (lightRevisions[i] != light->getRevision());
+		lightRevisions[i] = light->getRevision();
+		changed = changed || lightChanged;
+		
+		shadowMap &map = shadowMaps[i];
+		map.setBias(shadowBias);
+		if(!light->getCastShadows()){
+			map.invalidate();
+			continue;
+		}
+		if(map.isValid() && map.getSize() == shadowMapSize && !lightChanged && map.isAimedAt(sceneMin, sceneMax) && !anyInFrustum(map.getCamera(), moved))
+			continue; // Nothing which the map sees has changed
 		
-		if(drawNorm) // Draw the surface normal vector
-			drawVector(iter->p+offset, iter->norm, Colors::RED);
+		// Redraw the map, using only the objects which its camera is able to see. Objects which the map reaches
+		//  discard their colors through the map's revision number
+		map.setSize(shadowMapSize);
+		if(hasBounds && map.setLight(light, sceneMin, sceneMax)){
+			shadowCasters.clear();
+			objectTree.queryFrustum(map.getCamera(), shadowCasters);
+			map.render(shadowCasters);
+		}
+		else
+			map.invalidate();
+	}
+	objectTree.clearChanges();
+	if(changed) // Invalidates the shading cache of every object
+		lightingRevision++;
+}
+
+void scene::clipTriangle(const projectedVertex* const *verts, const unsigned short &clipMask, const drawMode &mode, const unsigned int &color){
+	clipVertex buffers[2][MAX_CLIP_VERTICES];
+	clipVertex *input = buffers[0];
+	clipVertex *output = buffers[1];
+	for(size_t i = 0; i < 3; i++){
+		input[i].x = verts[i]->cX;
+		input[i].y = verts[i]->cY;
+		input[i].z = verts[i]->cZ;
+		input[i].w = verts[i]->cW;
+		input[i].edge = true;
+	}
+	
+	// Clip the triangle against each plane which at least one of its vertices lies outside of
+	const clipPlane planes[5] = {CLIP_NEAR, GUARD_LEFT, GUARD_RIGHT, GUARD_BOTTOM, GUARD_TOP};
+	size_t nVertices = 3;
+	for(size_t i = 0; i < 5 && nVertices >= 3; i++){
+		if(!(clipMask & planes[i]))
+			continue;
+		nVertices = clipPolygon(input, nVertices, output, planes[i]);
+		std::swap(input, output);
+	}
+	if(nVertices < 3) // Triangle is entirely clipped
+		return;
+	
+	// Project the clipped polygon
+	int pX[MAX_CLIP_VERTICES], pY[MAX_CLIP_VERTICES];
+	float pZ[MAX_CLIP_VERTICES];
+	for(size_t i = 0; i < nVertices; i++){
+		double invW = 1/input[i].w;
+		pX[i] = snapToSubPixel(screenWidthPixels*((input[i].x*invW + 1)/2));
+		pY[i] = snapToSubPixel(screenHeightPixels*(1 - (input[i].y*invW + 1)/2));
+		pZ[i] = (float)(input[i].z*invW);
+	}
+	
+	// Split the polygon into a fan of triangles. Only outline edges which lie along edges of the original triangle
+	for(size_t i = 1; i+1 < nVertices; i++){
+		pixelTriplet pixels;
+		const size_t fan[3] = {0, i, i+1};
+		for(size_t j = 0; j < 3; j++){
+			pixels.pX[j] = pX[fan[j]];
+			pixels.pY[j] = pY[fan[j]];
+			pixels.pZ[j] = pZ[fan[j]];
+		}
+		unsigned char edges = 0;
+		if(i == 1 && input[0].edge)
+			edges |= 0x1;
+		if(input[i].edge)
+			edges |= 0x2;
+		if(i+2 == nVertices && input[i+1].edge)
+			edges |= 0x4;
+		submitTriangle(pixels, mode, color, edges);
+	}
+}
+
+void scene::submitTriangle(const pixelTriplet &pixels, const drawMode &mode, const unsigned int &color, const unsigned char &edges/*=0x7*/){
+	// Add the triangle to the list of things to draw. Filled triangles are binned by the 
+	//  rasterizer while edges are drawn on top of them once all triangles have been filled.
+	if(mode == WIREFRAME || mode == MESH){
+		edgesToDraw.push_back(edgeTriplet(pixels, false, edges));
+	}
+	else if(mode == SOLID){
+		// Draw the triangle face and the visible edges of the triangle
+		raster->addTriangle(pixels, color);
+		edgesToDraw.push_back(edgeTriplet(pixels, true, edges));
+	}
+	else if(mode == RENDER){
+		raster->addTriangle(pixels, color);
 	}
 }
 
@@ -194,13 +680,6 @@ bool scene::convertToPixelSpace(const double &x, const double &y, int &px, int &
 	return checkScreenSpace(x, y);
 }
 
-bool scene::convertToPixelSpace(const double *x, const double *y, pixelTriplet &coords){
-	bool retval = false;
-	for(size_t i = 0; i < 3; i++)
-		retval |= convertToPixelSpace(x[i], y[i], coords.pX[i], coords.pY[i]);
-	return retval;
-}
-
 void scene::drawPoint(const vector3 &point, const sdlColor &color){
 	double cmX, cmY;
 	if(cam->projectPoint(point, cmX, cmY)){
@@ -284,74 +763,50 @@ void scene::drawRay(const ray &proj, const sdlColor &color, const double &length
 	drawVector(proj.pos, proj.dir, color, length);
 }
 
-void scene::drawTriangle(const pixelTriplet &coords, const sdlColor &color){
-	window->setDrawColor(color);
-	for(size_t i = 0; i < 2; i++)
-		window->drawLine(coords.pX[i], coords.pY[i], coords.pX[i+1], coords.pY[i+1]);
-	window->drawLine(coords.pX[2], coords.pY[2], coords.pX[0], coords.pY[0]);
-}
-	
-void scene::drawFilledTriangle(const pixelTriplet &coords, const sdlColor &color){
-	int x0, y0;
-	int x1, y1;
-	int x2, y2;
+void scene::drawDepthLine(int x0, int y0, float q0, int x1, int y1, float q1){
+	frameBuffer *buffer = window->getBuffer();
 	
-	x0 = coords.pX[0]; y0 = coords.pY[0];
-	x1 = coords.pX[1]; y1 = coords.pY[1];
-	x2 = coords.pX[2]; y2 = coords.pY[2];
-
-	// Sort points by ascending Y
-	// Insertion sort
-	if(y1 < y0){
-		std::swap(y0, y1);
-		std::swap(x0, x1);
+	// Clip the line to the screen, keeping track of the depth at the clipped endpoints
+	int cx0 = x0, cy0 = y0, cx1 = x1, cy1 = y1;
+	if(!buffer->clipLine(cx0, cy0, cx1, cy1)) // Entire line is off the screen
+		return;
+	bool xMajor = (std::abs(x1-x0) >= std::abs(y1-y0));
+	double length = (xMajor ? x1-x0 : y1-y0);
+	if(length != 0){
+		double t0 = ((xMajor ? cx0-x0 : cy0-y0))/length;
+		double t1 = ((xMajor ? cx1-x0 : cy1-y0))/length;
+		float dq = q1 - q0;
+		q1 = (float)(q0 + t1*dq);
+		q0 = (float)(q0 + t0*dq);
 	}
-	if(y2 < y1){
-		std::swap(y1, y2);
-		std::swap(x1, x2);
-		if(y1 < y0){
-			std::swap(y1, y0);
-			std::swap(x1, x0);
-		}
+	
+	// Step along the major axis, interpolating the depth
+	int steps = std::max(std::abs(cx1-cx0), std::abs(cy1-cy0));
+	float dx = (steps > 0 ? float(cx1-cx0)/steps : 0);
+	float dy = (steps > 0 ? float(cy1-cy0)/steps : 0);
+	float dq = (steps > 0 ? (q1-q0)/steps : 0);
+	float x = cx0 + 0.5f, y = cy0 + 0.5f, q = q0;
+	for(int i = 0; i <= steps; i++, x += dx, y += dy, q += dq){
+		if(depth.test((int)x, (int)y, q, EDGE_DEPTH_BIAS))
+			buffer->drawPixel((int)x, (int)y);
 	}
+}
 
-	// Check if the triangle is on the screen
-	if(y2 < minPixelsY || y0 >= maxPixelsY) // Entire triangle is off the top or bottom of the screen
-		return;
-	
-	// Set the fill color
+void scene::drawTriangle(const pixelTriplet &coords, const sdlColor &color, const bool &depthTest/*=false*/, const unsigned char &edges/*=0x7*/){
+	// Lines are drawn between whole pixels
+	int pX[3], pY[3];
+	for(size_t i = 0; i < 3; i++){
+		pX[i] = coords.pX[i] >> SUBPIXEL_BITS;
+		pY[i] = coords.pY[i] >> SUBPIXEL_BITS;
+	}
 	window->setDrawColor(color);
-
-	// Check vertical pixel bounds	
-	int lineStart = (y0 >= minPixelsY ? y0 : minPixelsY);
-	int lineStop = (y2 < maxPixelsY ? y2 : maxPixelsY-1);
-	
-	float xA, xB;
-	for(int scanline = lineStart; scanline <= lineStop; scanline++){
-		if(y0 == y1){ // y10 is a horizontal line
-				xA = (scanline-y1)*(float(x2-x1))/(y2-y1) + x1;
-				xB = (scanline-y2)*(float(x0-x2))/(y0-y2) + x2;				
-		}
-		else if(y0 == y2){ // y20 is a horizontal line
-				xA = (scanline-y1)*(float(x2-x1))/(y2-y1) + x1;
-				xB = (scanline-y0)*(float(x1-x0))/(y1-y0) + x0;			
-		}
-		else{ // No lines are horizontal
-			if(scanline <= y1)
-				xA = (scanline-y0)*(float(x1-x0))/(y1-y0) + x0;
-			else
-				xA = (scanline-y1)*(float(x2-x1))/(y2-y1) + x1;
-			xB = (scanline-y2)*(float(x0-x2))/(y0-y2) + x2;
-		}
-
-		if(xB < xA) // Sort xA and xB
-			std::swap(xA, xB);
-
-		// Check if the line is on the screen
-		if(xB < minPixelsX || xA >= maxPixelsX) // Entire line is off the left or right of the screen
+	for(size_t i = 0; i < 3; i++){
+		if(!(edges & (1 << i)))
 			continue;
-
-		// Draw the scanline
-		window->drawLine((int)(xA >= minPixelsX ? xA : minPixelsX), scanline, (int)(xB < maxPixelsX ? xB : maxPixelsX-1), scanline);
+		size_t j = (i+1) % 3;
+		if(depthTest)
+			drawDepthLine(pX[i], pY[i], coords.pZ[i], pX[j], pY[j], coords.pZ[j]);
+		else
+			window->drawLine(pX[i], pY[i], pX[j], pY[j]);
 	}
 }
@@ -47,41 +47,16 @@ void sdlMouseEvent::decode(const SDL_MouseMotionEvent* evt){
 }
 
 sdlWindow::~sdlWindow(){
+	SDL_DestroyTexture(texture);
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 }
 
-void sdlWindow::setDrawColor(const sdlColor &color, const float &alpha/*=1*/){
-	SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, sdlColor::toUChar(alpha));
-}
-
-void sdlWindow::clear(const sdlColor &color/*=Colors::BLACK*/){
-	setDrawColor(color);
-	SDL_RenderClear(renderer);
-}
-
-void sdlWindow::drawPixel(const int &x, const int &y){
-	SDL_RenderDrawPoint(renderer, x, y);
-}
-
-void sdlWindow::drawPixel(const int *x, const int *y, const size_t &N){
-	for(size_t i = 0; i < N; i++) // Draw N pixels
-		drawPixel(x[i], y[i]);
-}
-
-void sdlWindow::drawLine(const int &x1, const int &y1, const int &x2, const int &y2){
-	SDL_RenderDrawLine(renderer, x1, y1, x2, y2);
-}
-
-void sdlWindow::drawLine(const int *x, const int *y, const size_t &N){
-	if(N == 0) // Nothing to draw
-		return;
-	for(size_t i = 0; i < N-1; i++)
-		drawLine(x[i], y[i], x[i+1], y[i+1]);
-}
-
 void sdlWindow::render(){
+	// Upload the entire framebuffer in one go and present it
+	SDL_UpdateTexture(texture, NULL, buffer.get(), buffer.getPitch());
+	SDL_RenderCopy(renderer, texture, NULL, NULL);
 	SDL_RenderPresent(renderer);
 }
 
@@ -119,7 +94,10 @@ void sdlWindow::initialize(){
 	// Open the SDL window
 	SDL_Init(SDL_INIT_VIDEO);
 	SDL_CreateWindowAndRenderer(W, H, 0, &window, &renderer);
-	clear();
 	
-	init = true;
+	// Create the streaming texture which the framebuffer is uploaded to
+	texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, W, H);
+	
+	// Allocate the framebuffer
+	renderTarget::initialize();
 }
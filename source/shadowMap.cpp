@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+
+#include "shadowMap.hpp"
+#include "object.hpp"
+#include "lightSource.hpp"
+
+void shadowMap::setSize(const int &size_){
+	if(size_ == size)
+		return;
+	size = (size_ > 0 ? size_ : 0);
+	depth.resize(size, size);
+	invalidate();
+}
+
+bool shadowMap::setLight(const lightSource *light, const vector3 &sceneMin_, const vector3 &sceneMax_){
+	sceneMin = sceneMin_;
+	sceneMax = sceneMax_;
+	if(!light->getShadowCamera(cam, sceneMin, sceneMax)){
+		invalidate();
+		return false;
+	}
+	return true;
+}
+
+void shadowMap::render(const std::vector<object*> &casters){
+	depth.clear();
+	const vector3 eye = cam.getPosition();
+	for(std::vector<object*>::const_iterator obj = casters.begin(); obj != casters.end(); obj++){
+		const mesh *geometry = (*obj)->getMesh();
+		if(geometry->empty())
+			continue;
+
+		// Project each unique vertex once, the same way that the scene does for the main camera
+		const vertexArray *vertices = geometry->getVertices();
+		const float *vX = vertices->getX();
+		const float *vY = vertices->getY();
+		const float *vZ = vertices->getZ();
+		matrix4 modelViewProj = cam.getViewProjectionMatrix()*(*obj)->getModelMatrix();
+		pX.resize(vertices->size());
+		pY.resize(vertices->size());
+		pZ.resize(vertices->size());
+		for(size_t i = 0; i < vertices->size(); i++){
+			double cX, cY, cZ, cW;
+			modelViewProj.transform(vector3(vX[i], vY[i], vZ[i]), cX, cY, cZ, cW);
+			if(cW <= cZ){ // Behind the viewing plane
+				pZ[i] = 0;
+				continue;
+			}
+			double invW = 1/cW;
+			pX[i] = (float)(size*((cX*invW + 1)/2));
+			pY[i] = (float)(size*(1 - (cY*invW + 1)/2));
+			pZ[i] = (float)(cZ*invW);
+		}
+
+		// Only draw the faces which point away from the light
+		vector3 local = eye - (*obj)->getPosition();
+		(*obj)->getRotation().transpose(local);
+		facing.assign((geometry->getNumberOfTriangles() + 31)/32, 0);
+		geometry->computeFacing(vector3f(local), &facing[0]);
+		unsigned int tri[3];
+		for(size_t i = 0; i < geometry->getNumberOfTriangles(); i++){
+			if(facing[i/32] & (1u << (i % 32)))
+				continue;
+			geometry->getTriangle(i, tri);
+			if(pZ[tri[0]] == 0 || pZ[tri[1]] == 0 || pZ[tri[2]] == 0) // Triangles crossing the viewing plane are not clipped
+				continue;
+			fillTriangle(tri[0], tri[1], tri[2]);
+		}
+	}
+	valid = true;
+	revision++;
+}
+
+void shadowMap::computeVisibility(const object *obj, const mesh *geometry, const size_t &first, const size_t &count, float *visibility) const {
+	const float *cX = geometry->getCentroids()->getX();
+	const float *cY = geometry->getCentroids()->getY();
+	const float *cZ = geometry->getCentroids()->getZ();
+	const double L = cam.getFocalLength();
+	matrix4 modelViewProj = cam.getViewProjectionMatrix()*obj->getModelMatrix();
+	for(size_t i = first; i < first + count; i++){
+		visibility[i] = 1;
+		if(!valid)
+			continue;
+		double x, y, z, w;
+		modelViewProj.transform(vector3(cX[i], cY[i], cZ[i]), x, y, z, w);
+		if(w <= z) // Behind the light
+			continue;
+		int px = (int)std::floor(size*((x/w + 1)/2));
+		int py = (int)std::floor(size*(1 - (y/w + 1)/2));
+		if(px < 0 || px >= size || py < 0 || py >= size)
+			continue;
+
+		// Compare distances along the viewing axis of the light, rather than reciprocal depths, so that the bias is
+		//  the same everywhere in the map
+		float q = depth.getDepth(px, py);
+		if(q > 0 && w > L/q + bias)
+			visibility[i] = 0;
+	}
+}
+
+void shadowMap::fillTriangle(const unsigned int &i0, const unsigned int &i1, const unsigned int &i2){
+	float x0 = pX[i0], y0 = pY[i0];
+	float x1 = pX[i1], y1 = pY[i1];
+	float x2 = pX[i2], y2 = pY[i2];
+
+	// Twice the signed area. The edge functions are flipped for triangles wound the other way, so both are drawn
+	float area = (x1 - x0)*(y2 - y0) - (y1 - y0)*(x2 - x0);
+	if(area == 0)
+		return;
+	float sign = (area > 0 ? 1.0f : -1.0f);
+	float invArea = 1/(area*sign);
+
+	// Bounding box of the triangle, clipped to the map
+	int minX = std::max(0, (int)std::floor(std::min(x0, std::min(x1, x2))));
+	int maxX = std::min(size - 1, (int)std::ceil(std::max(x0, std::max(x1, x2))));
+	int minY = std::max(0, (int)std::floor(std::min(y0, std::min(y1, y2))));
+	int maxY = std::min(size - 1, (int)std::ceil(std::max(y0, std::max(y1, y2))));
+	if(minX > maxX || minY > maxY)
+		return;
+
+	// Edge functions at the center of the first pixel, and their steps along a row and down a column
+	float startX = minX + 0.5f, startY = minY + 0.5f;
+	float e0 = sign*((x2 - x1)*(startY - y1) - (y2 - y1)*(startX - x1));
+	float e1 = sign*((x0 - x2)*(startY - y2) - (y0 - y2)*(startX - x2));
+	float e2 = sign*((x1 - x0)*(startY - y0) - (y1 - y0)*(startX - x0));
+	float stepX0 = -sign*(y2 - y1), stepY0 = sign*(x2 - x1);
+	float stepX1 = -sign*(y0 - y2), stepY1 = sign*(x0 - x2);
+	float stepX2 = -sign*(y1 - y0), stepY2 = sign*(x1 - x0);
+
+	// Reciprocal depth is linear in screen-space
+	float q0 = pZ[i0]*invArea, q1 = pZ[i1]*invArea, q2 = pZ[i2]*invArea;
+	for(int y = minY; y <= maxY; y++){
+		float *row = depth.getRowFloat(y);
+		float w0 = e0, w1 = e1, w2 = e2;
+		for(int x = minX; x <= maxX; x++){
+			if(w0 >= 0 && w1 >= 0 && w2 >= 0){
+				float q = w0*q0 + w1*q1 + w2*q2;
+				if(q > row[x])
+					row[x] = q;
+			}
+			w0 += stepX0;
+			w1 += stepX1;
+			w2 += stepX2;
+		}
+		e0 += stepY0;
+		e1 += stepY1;
+		e2 += stepY2;
+	}
+}
@@ -0,0 +1,96 @@
+#include "threadPool.hpp"
+
+threadPool::threadPool() : job(NULL), jobSize(0), nextIndex(0), generation(0), nBusy(0), stop(false) {
+	start(0);
+}
+
+threadPool::threadPool(const size_t &nThreads) : job(NULL), jobSize(0), nextIndex(0), generation(0), nBusy(0), stop(false) {
+	start(nThreads);
+}
+
+threadPool::~threadPool(){
+	join();
+}
+
+void threadPool::setNumberOfThreads(const size_t &nThreads){
+	join();
+	start(nThreads);
+}
+
+void threadPool::run(const size_t &N, const std::function<void(const size_t&)> &func){
+	if(N == 0)
+		return;
+	if(workers.empty() || N == 1){ // Not worth waking up the workers
+		for(size_t i = 0; i < N; i++)
+			func(i);
+		return;
+	}
+
+	// Publish the new job and wake up the workers
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		job = &func;
+		jobSize = N;
+		nextIndex = 0;
+		nBusy = workers.size();
+		generation++;
+	}
+	jobReady.notify_all();
+
+	// Help out with the job
+	work();
+
+	// Wait for all workers to finish
+	std::unique_lock<std::mutex> guard(lock);
+	jobDone.wait(guard, [this]{ return (nBusy == 0); });
+	job = NULL;
+}
+
+void threadPool::start(const size_t &nThreads){
+	size_t total = nThreads;
+	if(total == 0)
+		total = std::thread::hardware_concurrency();
+	if(total == 0) // Unable to determine the number of hardware threads
+		total = 1;
+	stop = false;
+	for(size_t i = 1; i < total; i++)
+		workers.push_back(std::thread(&threadPool::workerLoop, this, generation));
+}
+
+void threadPool::join(){
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		stop = true;
+	}
+	jobReady.notify_all();
+	for(std::vector<std::thread>::iterator iter = workers.begin(); iter != workers.end(); iter++)
+		iter->join();
+	workers.clear();
+}
+
+void threadPool::work(){
+	while(true){
+		size_t index = nextIndex++;
+		if(index >= jobSize)
+			break;
+		(*job)(index);
+	}
+}
+
+void threadPool::workerLoop(unsigned long long lastGeneration){
+	while(true){
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			jobReady.wait(guard, [&]{ return (stop || generation != lastGeneration); });
+			if(stop)
+				return;
+			lastGeneration = generation;
+		}
+		work();
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			if(--nBusy == 0)
+				jobDone.notify_one();
+		}
+	}
+}
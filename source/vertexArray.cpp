@@ -0,0 +1,358 @@
+#include <algorithm>
+#include <cmath>
+
+#include "vertexArray.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/** @class vertexKernelTable
+  * @brief The vertex kernels currently in use by all vertex arrays
+  */
+
+class vertexKernelTable{
+public:
+	vertexArray::simdLevel simd; ///< The instruction set used by the kernels
+	vertexFacingKernel facing; ///< Kernel used by vertexArray::computeFacing()
+	vertexShadeKernel shade; ///< Kernel used by vertexArray::computeShading()
+
+	/** Default constructor. Selects the best kernels supported by the CPU
+	  */
+	vertexKernelTable(){
+		set(vertexArray::getSupportedSimdLevel());
+	}
+
+	/** Select the kernels for an instruction set
+	  */
+	void set(const vertexArray::simdLevel &level){
+		simd = level;
+		switch(simd){
+			case vertexArray::SIMD_AVX2:
+				facing = computeFacingAVX2;
+				shade = computeShadingAVX2;
+				break;
+			case vertexArray::SIMD_SSE2:
+				facing = computeFacingSSE2;
+				shade = computeShadingSSE2;
+				break;
+			default:
+				facing = computeFacingScalar;
+				shade = computeShadingScalar;
+				break;
+		}
+	}
+};
+
+/** Get the kernel table, selecting the kernels the first time it is used
+  */
+static vertexKernelTable& getKernels(){
+	static vertexKernelTable table;
+	return table;
+}
+
+vertexArray::vertexArray(const vertexArray &other) : block(NULL), x(NULL), y(NULL), z(NULL), count(0), capacity(0) {
+	(*this) = other;
+}
+
+vertexArray::~vertexArray(){
+	delete[] block;
+}
+
+vertexArray& vertexArray::operator = (const vertexArray &rhs){
+	if(&rhs == this)
+		return (*this);
+	resize(rhs.count);
+	std::copy(rhs.x, rhs.x+count, x);
+	std::copy(rhs.y, rhs.y+count, y);
+	std::copy(rhs.z, rhs.z+count, z);
+	return (*this);
+}
+
+void vertexArray::push_back(const vector3f &vec){
+	if(count == capacity)
+		reserve(std::max(2*capacity, (size_t)BLOCK_SIZE));
+	x[count] = vec.x;
+	y[count] = vec.y;
+	z[count] = vec.z;
+	count++;
+}
+
+void vertexArray::resize(const size_t &size){
+	reserve(size);
+	for(size_t i = count; i < size; i++){
+		x[i] = 0;
+		y[i] = 0;
+		z[i] = 0;
+	}
+	count = size;
+}
+
+void vertexArray::reserve(const size_t &size){
+	if(size <= capacity)
+		return;
+
+	// Round up to a whole number of blocks, so each array stays aligned and the kernels never run off the end
+	size_t newCapacity = (size + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1);
+
+	// Allocate enough extra room to align the start of the storage
+	const size_t extra = ALIGNMENT/sizeof(float);
+	float *newBlock = new float[3*newCapacity + extra];
+	size_t offset = (ALIGNMENT - ((size_t)newBlock % ALIGNMENT)) % ALIGNMENT;
+	float *newX = (float*)((char*)newBlock + offset);
+	float *newY = newX + newCapacity;
+	float *newZ = newY + newCapacity;
+
+	// Copy the existing points and zero the rest, including the padding
+	std::fill(newX, newX + 3*newCapacity, 0.0f);
+	std::copy(x, x+count, newX);
+	std::copy(y, y+count, newY);
+	std::copy(z, z+count, newZ);
+
+	delete[] block;
+	block = newBlock;
+	x = newX;
+	y = newY;
+	z = newZ;
+	capacity = newCapacity;
+}
+
+void vertexArray::computeFacing(const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &nFaces, unsigned int *mask) const {
+	if(nFaces == 0)
+		return;
+	const size_t last = first + nFaces;
+	std::fill(mask + first/32, mask + (last + 31)/32, 0u);
+	getKernels().facing((*this), centroids, point, first, last, mask);
+	
+	// Clear the bits of any elements which the kernel evaluated past the end of the range
+	if(last % 32)
+		mask[last/32] &= (1u << (last % 32)) - 1;
+}
+
+void vertexArray::computeShading(const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &nFaces, const bool &srgb, unsigned int *colors) const {
+	if(nFaces == 0)
+		return;
+	getKernels().shade((*this), centroids, lights, nLights, first, first + nFaces, srgb, colors);
+}
+
+float vertexArray::getMaxSquareDistance(const vector3f &point) const {
+	float maxSquare = 0;
+	size_t i = 0;
+#if defined(__SSE2__)
+	// Four points at a time. The padding is not part of the array, so the last few points are handled below
+	__m128 cx = _mm_set1_ps(point.x), cy = _mm_set1_ps(point.y), cz = _mm_set1_ps(point.z);
+	__m128 largest = _mm_setzero_ps();
+	for(; i+4 <= count; i += 4){
+		__m128 dx = _mm_sub_ps(_mm_load_ps(&x[i]), cx);
+		__m128 dy = _mm_sub_ps(_mm_load_ps(&y[i]), cy);
+		__m128 dz = _mm_sub_ps(_mm_load_ps(&z[i]), cz);
+		largest = _mm_max_ps(largest, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+	}
+	float lanes[4];
+	_mm_storeu_ps(lanes, largest);
+	for(int j = 0; j < 4; j++)
+		maxSquare = std::max(maxSquare, lanes[j]);
+#endif
+	for(; i < count; i++){
+		float dx = x[i] - point.x;
+		float dy = y[i] - point.y;
+		float dz = z[i] - point.z;
+		maxSquare = std::max(maxSquare, dx*dx + dy*dy + dz*dz);
+	}
+	return maxSquare;
+}
+
+vertexArray::simdLevel vertexArray::getSimdLevel(){
+	return getKernels().simd;
+}
+
+void vertexArray::setSimdLevel(const simdLevel &level){
+	getKernels().set(std::min(level, getSupportedSimdLevel()));
+}
+
+vertexArray::simdLevel vertexArray::getSupportedSimdLevel(){
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	if(vertexAVX2Compiled() && __builtin_cpu_supports("avx2"))
+		return SIMD_AVX2;
+	if(vertexSSE2Compiled() && __builtin_cpu_supports("sse2"))
+		return SIMD_SSE2;
+#endif
+	return SIMD_NONE;
+}
+
+/////////////////////////////////////////////////
+// Scalar kernels
+/////////////////////////////////////////////////
+
+void computeFacingScalar(const vertexArray &normals, const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask){
+	const float *nX = normals.getX(), *nY = normals.getY(), *nZ = normals.getZ();
+	const float *cX = centroids.getX(), *cY = centroids.getY(), *cZ = centroids.getZ();
+	for(size_t i = first; i < last; i++){
+		// Signed distance from the plane of the face to the point
+		float dist = (point.x - cX[i])*nX[i] + (point.y - cY[i])*nY[i] + (point.z - cZ[i])*nZ[i];
+		if(!(dist < 0))
+			mask[i/32] |= 1u << (i % 32);
+	}
+}
+
+void computeShadingScalar(const vertexArray &normals, const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors){
+	const float *nX = normals.getX(), *nY = normals.getY(), *nZ = normals.getZ();
+	const float *cX = centroids.getX(), *cY = centroids.getY(), *cZ = centroids.getZ();
+	for(size_t i = first; i < last; i++){
+		linearColor lit(0);
+		for(const faceLight *light = lights; light != lights + nLights; light++){
+			float intensity;
+			if(light->type == faceLight::DIRECTIONAL){ // Cosine of the angle between the face normal and the rays
+				intensity = -(light->direction.x*nX[i] + light->direction.y*nY[i] + light->direction.z*nZ[i]);
+			}
+			else{ // Cosine of the angle between the face normal and the ray to the face, divided by the distance
+				float dx = cX[i] - light->position.x, dy = cY[i] - light->position.y, dz = cZ[i] - light->position.z;
+				float distSquare = dx*dx + dy*dy + dz*dz;
+				intensity = -(dx*nX[i] + dy*nY[i] + dz*nZ[i])/distSquare;
+				if(!(distSquare <= light->rangeSquare))
+					intensity = 0;
+				else if(light->type == faceLight::CONE && (dx*light->direction.x + dy*light->direction.y + dz*light->direction.z) < light->cosHalfAngle*std::sqrt(distSquare))
+					intensity = 0;
+			}
+			if(light->visibility) // Shadowed
+				intensity *= light->visibility[i];
+			if(intensity > 0)
+				lit += light->color*intensity;
+		}
+		colors[i] = lit.toARGB(srgb);
+	}
+}
+
+/////////////////////////////////////////////////
+// SSE2 kernels
+/////////////////////////////////////////////////
+
+#if defined(__SSE2__)
+
+void computeFacingSSE2(const vertexArray &normals, const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask){
+	const float *nX = normals.getX(), *nY = normals.getY(), *nZ = normals.getZ();
+	const float *cX = centroids.getX(), *cY = centroids.getY(), *cZ = centroids.getZ();
+	const __m128 px = _mm_set1_ps(point.x), py = _mm_set1_ps(point.y), pz = _mm_set1_ps(point.z);
+	const __m128 zero = _mm_setzero_ps();
+
+	// The range starts on a block boundary and both arrays are padded to whole blocks, so the last group of four
+	//  may run past the end of the range, or into the padding
+	for(size_t i = first; i < last; i += 4){
+		__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(px, _mm_load_ps(&cX[i])), _mm_load_ps(&nX[i])),
+		                                    _mm_mul_ps(_mm_sub_ps(py, _mm_load_ps(&cY[i])), _mm_load_ps(&nY[i]))),
+		                                    _mm_mul_ps(_mm_sub_ps(pz, _mm_load_ps(&cZ[i])), _mm_load_ps(&nZ[i])));
+		mask[i/32] |= (unsigned int)_mm_movemask_ps(_mm_cmpnlt_ps(dist, zero)) << (i % 32);
+	}
+}
+
+/** Encode four linear values in the range [0, 1] using the same sRGB approximation as linearColor::encodeSRGB()
+  */
+static inline __m128 encodeSRGBSSE2(const __m128 &value){
+	__m128 root2 = _mm_sqrt_ps(value);
+	__m128 root4 = _mm_sqrt_ps(root2);
+	__m128 root8 = _mm_sqrt_ps(root4);
+	__m128 curve = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.662002687f), root2), _mm_mul_ps(_mm_set1_ps(0.684122060f), root4)), _mm_mul_ps(_mm_set1_ps(0.323583601f), root8)), _mm_mul_ps(_mm_set1_ps(0.0225411470f), value));
+	__m128 dark = _mm_cmple_ps(value, _mm_set1_ps(0.0031308f));
+	return _mm_or_ps(_mm_and_ps(dark, _mm_mul_ps(_mm_set1_ps(12.92f), value)), _mm_andnot_ps(dark, curve));
+}
+
+/** Clamp four linear colors to the range [0, 1] and pack them into ARGB8888 pixel values, optionally sRGB encoded
+  */
+static inline __m128i packColorsSSE2(__m128 red, __m128 green, __m128 blue, const bool &srgb){
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1), scale = _mm_set1_ps(255);
+	red = _mm_min_ps(_mm_max_ps(red, zero), one);
+	green = _mm_min_ps(_mm_max_ps(green, zero), one);
+	blue = _mm_min_ps(_mm_max_ps(blue, zero), one);
+	if(srgb){
+		red = encodeSRGBSSE2(red);
+		green = encodeSRGBSSE2(green);
+		blue = encodeSRGBSSE2(blue);
+	}
+	__m128i r = _mm_cvttps_epi32(_mm_mul_ps(red, scale));
+	__m128i g = _mm_cvttps_epi32(_mm_mul_ps(green, scale));
+	__m128i b = _mm_cvttps_epi32(_mm_mul_ps(blue, scale));
+	return _mm_or_si128(_mm_or_si128(_mm_set1_epi32(0xFF000000), _mm_slli_epi32(r, 16)), _mm_or_si128(_mm_slli_epi32(g, 8), b));
+}
+
+void computeShadingSSE2(const vertexArray &normals, const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors){
+	const float *nX = normals.getX(), *nY = normals.getY(), *nZ = normals.getZ();
+	const float *cX = centroids.getX(), *cY = centroids.getY(), *cZ = centroids.getZ();
+	const __m128 zero = _mm_setzero_ps();
+
+	// The range starts on a block boundary and both arrays are padded to whole blocks, so the last group of four
+	//  may run past the end of the range, or into the padding
+	for(size_t i = first; i < last; i += 4){
+		__m128 normX = _mm_load_ps(&nX[i]), normY = _mm_load_ps(&nY[i]), normZ = _mm_load_ps(&nZ[i]);
+		__m128 red = zero, green = zero, blue = zero;
+		for(const faceLight *light = lights; light != lights + nLights; light++){
+			__m128 intensity;
+			if(light->type == faceLight::DIRECTIONAL){
+				intensity = _mm_sub_ps(zero, _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(light->direction.x), normX), _mm_mul_ps(_mm_set1_ps(light->direction.y), normY)), _mm_mul_ps(_mm_set1_ps(light->direction.z), normZ)));
+			}
+			else{
+				__m128 dx = _mm_sub_ps(_mm_load_ps(&cX[i]), _mm_set1_ps(light->position.x));
+				__m128 dy = _mm_sub_ps(_mm_load_ps(&cY[i]), _mm_set1_ps(light->position.y));
+				__m128 dz = _mm_sub_ps(_mm_load_ps(&cZ[i]), _mm_set1_ps(light->position.z));
+				__m128 distSquare = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+				intensity = _mm_div_ps(_mm_sub_ps(zero, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, normX), _mm_mul_ps(dy, normY)), _mm_mul_ps(dz, normZ))), distSquare);
+				__m128 inside = _mm_cmple_ps(distSquare, _mm_set1_ps(light->rangeSquare));
+				if(light->type == faceLight::CONE){
+					__m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_set1_ps(light->direction.x)), _mm_mul_ps(dy, _mm_set1_ps(light->direction.y))), _mm_mul_ps(dz, _mm_set1_ps(light->direction.z)));
+					inside = _mm_and_ps(inside, _mm_cmpnlt_ps(along, _mm_mul_ps(_mm_set1_ps(light->cosHalfAngle), _mm_sqrt_ps(distSquare))));
+				}
+				intensity = _mm_and_ps(intensity, inside);
+			}
+			if(light->visibility) // Shadowed
+				intensity = _mm_mul_ps(intensity, _mm_loadu_ps(&light->visibility[i]));
+			intensity = _mm_and_ps(intensity, _mm_cmpgt_ps(intensity, zero)); // Also clears NaN
+			red = _mm_add_ps(red, _mm_mul_ps(intensity, _mm_set1_ps(light->color.r)));
+			green = _mm_add_ps(green, _mm_mul_ps(intensity, _mm_set1_ps(light->color.g)));
+			blue = _mm_add_ps(blue, _mm_mul_ps(intensity, _mm_set1_ps(light->color.b)));
+		}
+		_mm_storeu_si128((__m128i*)&colors[i], packColorsSSE2(red, green, blue, srgb));
+	}
+}
+
+bool vertexSSE2Compiled(){
+	return true;
+}
+
+#else
+
+void computeFacingSSE2(const vertexArray &normals, const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask){
+	computeFacingScalar(normals, centroids, point, first, last, mask);
+}
+
+void computeShadingSSE2(const vertexArray &normals, const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors){
+	computeShadingScalar(normals, centroids, lights, nLights, first, last, srgb, colors);
+}
+
+bool vertexSSE2Compiled(){
+	return false;
+}
+
+#endif
+
+/////////////////////////////////////////////////
+// AVX2 kernels
+/////////////////////////////////////////////////
+
+// The arrays are unpacked here, rather than in vertexArrayAVX2.cpp, so that the inline members of vertexArray are
+//  never compiled with AVX2 code generation
+
+void computeFacingAVX2(const vertexArray &normals, const vertexArray &centroids, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask){
+	if(!vertexAVX2Compiled()){
+		computeFacingScalar(normals, centroids, point, first, last, mask);
+		return;
+	}
+	computeFacingAVX2Raw(normals.getX(), normals.getY(), normals.getZ(), centroids.getX(), centroids.getY(), centroids.getZ(), point, first, last, mask);
+}
+
+void computeShadingAVX2(const vertexArray &normals, const vertexArray &centroids, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors){
+	if(!vertexAVX2Compiled()){
+		computeShadingScalar(normals, centroids, lights, nLights, first, last, srgb, colors);
+		return;
+	}
+	computeShadingAVX2Raw(normals.getX(), normals.getY(), normals.getZ(), centroids.getX(), centroids.getY(), centroids.getZ(), lights, nLights, first, last, srgb, colors);
+}
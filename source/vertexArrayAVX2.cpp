@@ -0,0 +1,106 @@
+#include "vertexArray.hpp"
+
+// This file is compiled with AVX2 code generation enabled (when the compiler supports it).
+//  Nothing in here may be called unless the CPU reports AVX2 support at runtime. The kernels take raw arrays so that
+//  no inline member of vertexArray (or any other class) is compiled here, where the linker could pick the AVX2 copy
+//  for the rest of the program.
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+void computeFacingAVX2Raw(const float *nX, const float *nY, const float *nZ, const float *cX, const float *cY, const float *cZ, const vector3f &point, const size_t &first, const size_t &last, unsigned int *mask){
+	const __m256 px = _mm256_set1_ps(point.x), py = _mm256_set1_ps(point.y), pz = _mm256_set1_ps(point.z);
+	const __m256 zero = _mm256_setzero_ps();
+
+	// The range starts on a block boundary and both arrays are padded to whole blocks of eight, so the last block
+	//  may run past the end of the range, or into the padding
+	for(size_t i = first; i < last; i += 8){
+		__m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(px, _mm256_load_ps(&cX[i])), _mm256_load_ps(&nX[i])),
+		                                          _mm256_mul_ps(_mm256_sub_ps(py, _mm256_load_ps(&cY[i])), _mm256_load_ps(&nY[i]))),
+		                                          _mm256_mul_ps(_mm256_sub_ps(pz, _mm256_load_ps(&cZ[i])), _mm256_load_ps(&nZ[i])));
+		mask[i/32] |= (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(dist, zero, _CMP_NLT_UQ)) << (i % 32);
+	}
+}
+
+/** Encode eight linear values in the range [0, 1] using the same sRGB approximation as linearColor::encodeSRGB()
+  */
+static inline __m256 encodeSRGB(const __m256 &value){
+	__m256 root2 = _mm256_sqrt_ps(value);
+	__m256 root4 = _mm256_sqrt_ps(root2);
+	__m256 root8 = _mm256_sqrt_ps(root4);
+	__m256 curve = _mm256_sub_ps(_mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.662002687f), root2), _mm256_mul_ps(_mm256_set1_ps(0.684122060f), root4)), _mm256_mul_ps(_mm256_set1_ps(0.323583601f), root8)), _mm256_mul_ps(_mm256_set1_ps(0.0225411470f), value));
+	return _mm256_blendv_ps(curve, _mm256_mul_ps(_mm256_set1_ps(12.92f), value), _mm256_cmp_ps(value, _mm256_set1_ps(0.0031308f), _CMP_LE_OQ));
+}
+
+/** Clamp eight linear colors to the range [0, 1] and pack them into ARGB8888 pixel values, optionally sRGB encoded
+  */
+static inline __m256i packColors(__m256 red, __m256 green, __m256 blue, const bool &srgb){
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1), scale = _mm256_set1_ps(255);
+	red = _mm256_min_ps(_mm256_max_ps(red, zero), one);
+	green = _mm256_min_ps(_mm256_max_ps(green, zero), one);
+	blue = _mm256_min_ps(_mm256_max_ps(blue, zero), one);
+	if(srgb){
+		red = encodeSRGB(red);
+		green = encodeSRGB(green);
+		blue = encodeSRGB(blue);
+	}
+	__m256i r = _mm256_cvttps_epi32(_mm256_mul_ps(red, scale));
+	__m256i g = _mm256_cvttps_epi32(_mm256_mul_ps(green, scale));
+	__m256i b = _mm256_cvttps_epi32(_mm256_mul_ps(blue, scale));
+	return _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi32(0xFF000000), _mm256_slli_epi32(r, 16)), _mm256_or_si256(_mm256_slli_epi32(g, 8), b));
+}
+
+void computeShadingAVX2Raw(const float *nX, const float *nY, const float *nZ, const float *cX, const float *cY, const float *cZ, const faceLight *lights, const size_t &nLights, const size_t &first, const size_t &last, const bool &srgb, unsigned int *colors){
+	const __m256 zero = _mm256_setzero_ps();
+
+	// The range starts on a block boundary and both arrays are padded to whole blocks of eight, so the last block
+	//  may run past the end of the range, or into the padding
+	for(size_t i = first; i < last; i += 8){
+		__m256 normX = _mm256_load_ps(&nX[i]), normY = _mm256_load_ps(&nY[i]), normZ = _mm256_load_ps(&nZ[i]);
+		__m256 red = zero, green = zero, blue = zero;
+		for(const faceLight *light = lights; light != lights + nLights; light++){
+			__m256 intensity;
+			if(light->type == faceLight::DIRECTIONAL){
+				intensity = _mm256_sub_ps(zero, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(light->direction.x), normX), _mm256_mul_ps(_mm256_set1_ps(light->direction.y), normY)), _mm256_mul_ps(_mm256_set1_ps(light->direction.z), normZ)));
+			}
+			else{
+				__m256 dx = _mm256_sub_ps(_mm256_load_ps(&cX[i]), _mm256_set1_ps(light->position.x));
+				__m256 dy = _mm256_sub_ps(_mm256_load_ps(&cY[i]), _mm256_set1_ps(light->position.y));
+				__m256 dz = _mm256_sub_ps(_mm256_load_ps(&cZ[i]), _mm256_set1_ps(light->position.z));
+				__m256 distSquare = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+				intensity = _mm256_div_ps(_mm256_sub_ps(zero, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, normX), _mm256_mul_ps(dy, normY)), _mm256_mul_ps(dz, normZ))), distSquare);
+				__m256 inside = _mm256_cmp_ps(distSquare, _mm256_set1_ps(light->rangeSquare), _CMP_LE_OQ);
+				if(light->type == faceLight::CONE){
+					__m256 along = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, _mm256_set1_ps(light->direction.x)), _mm256_mul_ps(dy, _mm256_set1_ps(light->direction.y))), _mm256_mul_ps(dz, _mm256_set1_ps(light->direction.z)));
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(along, _mm256_mul_ps(_mm256_set1_ps(light->cosHalfAngle), _mm256_sqrt_ps(distSquare)), _CMP_NLT_UQ));
+				}
+				intensity = _mm256_and_ps(intensity, inside);
+			}
+			if(light->visibility) // Shadowed
+				intensity = _mm256_mul_ps(intensity, _mm256_loadu_ps(&light->visibility[i]));
+			intensity = _mm256_and_ps(intensity, _mm256_cmp_ps(intensity, zero, _CMP_GT_OQ)); // Also clears NaN
+			red = _mm256_add_ps(red, _mm256_mul_ps(intensity, _mm256_set1_ps(light->color.r)));
+			green = _mm256_add_ps(green, _mm256_mul_ps(intensity, _mm256_set1_ps(light->color.g)));
+			blue = _mm256_add_ps(blue, _mm256_mul_ps(intensity, _mm256_set1_ps(light->color.b)));
+		}
+		_mm256_storeu_si256((__m256i*)&colors[i], packColors(red, green, blue, srgb));
+	}
+}
+
+bool vertexAVX2Compiled(){
+	return true;
+}
+
+#else
+
+// Never called, the AVX2 kernels in vertexArray.cpp fall back to the scalar kernels when these are not compiled
+
+void computeFacingAVX2Raw(const float *, const float *, const float *, const float *, const float *, const float *, const vector3f &, const size_t &, const size_t &, unsigned int *){ }
+
+void computeShadingAVX2Raw(const float *, const float *, const float *, const float *, const float *, const float *, const faceLight *, const size_t &, const size_t &, const size_t &, const bool &, unsigned int *){ }
+
+bool vertexAVX2Compiled(){
+	return false;
+}
+
+#endif